@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// opt-in heap instrumentation
+// build with -DALLOC_TRACKING to replace global operator new/delete, otherwise the scopes compile to nothing and the counters just stay at zero
+//
+// usage:
+//   ALLOC_SCOPE("collision");     // attribute allocations in this block to "collision"
+//   AllocTracker::endFrame();     // once per frame, closes the frame's counters
+//
+// steady state = median allocations per frame after the warmup frames, peak = worst frame seen
+
+#ifdef ALLOC_TRACKING
+constexpr bool allocTrackingEnabled = true;
+#else
+constexpr bool allocTrackingEnabled = false;
+#endif
+
+class AllocTracker {
+public:
+    static constexpr int maxScopes = 32;
+    static constexpr int historySize = 1024; // frames kept for the steady state figure
+    static constexpr int untrackedScope = 0; // anything allocated outside of a named scope
+
+    struct FrameStats {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        uint64_t frees = 0;
+    };
+
+    // name must outlive the tracker (string literal)
+    static int registerScope(const char* name);
+    static int enterScope(int id); // returns the previous scope
+    static void exitScope(int previous);
+
+    static void endFrame();
+
+    static void setWarmupFrames(int frames) { warmupFrames = frames; }
+    static void setBudget(uint64_t allocationsPerFrame) { budget = allocationsPerFrame; budgetSet = true; }
+    static uint64_t getBudget() { return budget; }
+    static bool hasBudget() { return budgetSet; }
+
+    static FrameStats lastFrame();
+    static uint64_t steadyStateAllocations(); // median over the history, after warmup
+    static uint64_t peakAllocations();
+    static int framesRecorded();
+
+    // false if a budget is set and the steady state frame goes over it
+    static bool withinBudget();
+    static void report(std::ostream& out);
+
+    // called from the replaced operator new/delete
+    static void recordAllocation(size_t bytes);
+    static void recordFree();
+
+private:
+    static int warmupFrames;
+    static uint64_t budget; // 0 is a budget too, nothing may allocate in the steady state
+    static bool budgetSet;
+};
+
+class AllocScope {
+private:
+    int previous;
+public:
+    explicit AllocScope(int id) : previous(AllocTracker::enterScope(id)) {}
+    ~AllocScope() { AllocTracker::exitScope(previous); }
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+};
+
+#define ALLOC_SCOPE_CONCAT_INNER(a, b) a##b
+#define ALLOC_SCOPE_CONCAT(a, b) ALLOC_SCOPE_CONCAT_INNER(a, b)
+
+#ifdef ALLOC_TRACKING
+// registers the name once per call site, then just swaps a thread local on entry/exit
+#define ALLOC_SCOPE(name) \
+    static const int ALLOC_SCOPE_CONCAT(allocScopeId_, __LINE__) = AllocTracker::registerScope(name); \
+    AllocScope ALLOC_SCOPE_CONCAT(allocScope_, __LINE__)(ALLOC_SCOPE_CONCAT(allocScopeId_, __LINE__))
+#else
+#define ALLOC_SCOPE(name) ((void)0)
+#endif
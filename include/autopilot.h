@@ -0,0 +1,64 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <vector>
+#include "utils.h"
+#include "random.h"
+#include "spawn_director.h"
+
+class GameManager;
+class Player;
+
+// plays the game by itself, for soak tests that have to run for hours with nobody at the keyboard
+// it only ever produces the same SDL events a person would (arrow keys, left clicks, R on game over), so
+// whatever it does goes through checkMovement / processEvent, can be recorded and replays like live input
+//
+// every step: dodge out of the lane of any beam that's still coming (warning / expanding / active),
+// kite away from nearby triangles and pentagons without getting pinned to a wall, and click at the densest
+// clump of enemies. some shots go at the window edges on purpose to keep it resizing
+// intensity scales the click rate, the edge shots and (through applyPressure) how hard the spawner pushes
+class Autopilot {
+public:
+    struct Settings {
+        float intensity = 0.5f;      // 0: casual, 1: flat out, more than 1 works but nobody survives it
+        float shotsPerSecond = 0.0f; // all of these are derived from intensity in the constructor
+        float edgeShotShare = 0.0f;  // fraction of shots aimed at the window edges instead of enemies (a bigger window helps it survive too)
+        float kiteRadius = 260.0f;
+        float clusterRadius = 150.0f;
+        float beamMargin = 40.0f;    // extra room on top of the player's radius when leaving a beam lane
+    };
+
+private:
+    Settings settings;
+    Pcg32 random;                // its own stream, only used for edge shots
+    float shotCredit = 0.0f;     // shots owed, fractional ones carry over to the next step
+    std::vector<SDL_Event> pending; // this step's events, reused
+
+    Vector2D steer(GameManager& game, const Player& player, const SDL_Rect& bounds) const;
+    bool findCluster(GameManager& game, Vector2D& aim) const; // false if there's nothing to shoot at
+    void pressKeys(const InputState& held, Vector2D want);
+    void click(Vector2D at);
+    void think(GameManager& game); // fills pending
+
+public:
+    Autopilot(float intensity, uint64_t seed);
+
+    const Settings& getSettings() const { return settings; }
+
+    // more waves, shorter gaps and a higher cap, so high intensity also means lots of objects
+    // call once while setting the game up, the spawner settings aren't part of the saved state
+    void applyPressure(SpawnDirector::Settings& spawns) const;
+
+    // between steps, before game.update(): works out what to press and hands every event to fn in order
+    template <typename Fn>
+    void drive(GameManager& game, Fn&& fn) {
+        think(game);
+        for (const SDL_Event& event : pending) {
+            fn(event);
+        }
+    }
+
+    // what the sim thread does with gameplay input, for drivers that don't have one (headless, batch)
+    static void deliver(GameManager& game, const SDL_Event& event);
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+class GameManager;
+class Window;
+class Player;
+class JobSystem;
+
+// one entry per world in every array, so a column can be summed or sorted without dragging the rest along
+struct BatchResults {
+    std::vector<uint64_t> seeds;
+    std::vector<uint64_t> ticks;       // steps the session lasted
+    std::vector<int32_t> scores;       // player score when it ended
+    std::vector<uint8_t> died;         // 1: ended in a game over, 0: ran out of ticks
+    std::vector<uint32_t> peakObjects;
+    std::vector<uint64_t> stateHashes; // world at the end, the same seeds always give the same hashes
+
+    void resize(size_t worlds);
+    size_t size() const { return seeds.size(); }
+    uint64_t combinedHash() const; // over every world's final hash, one number to compare two runs by
+    void report(std::ostream& out) const;
+};
+
+// steps lots of independent games side by side, for checking a tuning change over thousands of sessions
+// every world has its own window geometry, context (rng, input, scripts, tweens) and objects. the job system
+// spreads whole worlds over its threads (each world runs single threaded), and every world takes syncInterval
+// steps between lockstep points. a session ends at its first game over or after maxTicks
+class BatchRunner {
+public:
+    // before every step of a world, on whichever thread is running it: set game.getContext().input,
+    // or hand events to game.handleInput(). player is null once it's gone
+    using InputFn = std::function<void(size_t world, GameManager& game, Player* player)>;
+
+    struct Settings {
+        size_t worlds = 64;
+        uint64_t firstSeed = 1; // world i runs seed firstSeed + i
+        uint64_t maxTicks = 36000;
+        uint64_t syncInterval = 1; // steps per world between lockstep points
+        bool simLod = true;
+    };
+
+private:
+    struct World {
+        std::unique_ptr<Window> window;
+        std::unique_ptr<GameManager> game;
+        bool done = false;
+    };
+
+    Settings settings;
+    JobSystem& jobs;
+    std::vector<World> worlds;
+    InputFn inputs;
+    BatchResults results;
+    uint64_t syncs = 0;
+
+    void stepWorld(size_t index, uint64_t steps);
+
+public:
+    BatchRunner(const Settings& settings, JobSystem& jobs);
+    ~BatchRunner();
+
+    void setInputs(InputFn fn) { inputs = std::move(fn); }
+
+    // until every session is over
+    void run();
+
+    const BatchResults& getResults() const { return results; }
+    uint64_t getSyncs() const { return syncs; }
+    size_t getWorldCount() const { return worlds.size(); }
+    GameManager& getGame(size_t world) { return *worlds[world].game; } // for setup, before run()
+};
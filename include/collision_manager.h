@@ -15,7 +15,9 @@ public:
 
     void setGameManager(GameManager* gm) { gameManager = gm; }
     void addObject(GameObject* obj) { objects.push_back(obj); }
+    void addObjects(const std::vector<GameObject*>& batch); // bulk insert, one reserve for the whole batch
     void removeObject(GameObject* obj);
+    void removeInactiveObjects(); // single pass instead of a find per dead object
     void clear() { objects.clear(); } // Add method to clear all objects
     void checkCollisions();
     void handleCollision(GameObject* obj1, GameObject* obj2);
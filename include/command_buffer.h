@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include "mpsc_queue.h"
+#include "entities.h"
+
+// deferred spawn/despawn requests
+// anything (event handlers, collision callbacks, worker threads) can queue commands,
+// the game manager applies them all at once at the end of its update so nothing touches
+// gameObjects or the collision list while they are being iterated
+class CommandBuffer {
+public:
+    enum class CommandType {
+        Spawn,
+        Despawn
+    };
+
+    struct Command {
+        CommandType type;
+        std::unique_ptr<GameObject> object; // spawn
+        GameObject* target;                 // despawn
+    };
+
+private:
+    MpscQueue<Command> commands;
+
+public:
+    void spawn(std::unique_ptr<GameObject> object) {
+        commands.push(Command{CommandType::Spawn, std::move(object), nullptr});
+    }
+
+    // only the first request for an object is queued, so a projectile that overlaps
+    // two triangles in the same frame still only hits one
+    void despawn(GameObject* object) {
+        if (object && object->markForDespawn()) {
+            commands.push(Command{CommandType::Despawn, nullptr, object});
+        }
+    }
+
+    template <typename Fn>
+    size_t apply(Fn&& fn) { return commands.drain(std::forward<Fn>(fn)); }
+
+    void clear() { commands.clear(); }
+    bool empty() const { return commands.empty(); }
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// side effects of an entity update that reach outside the entity (window resizes, game over)
+// entities update in parallel, so each thread collects these in its own queue and the game manager
+// applies them afterwards in object order, the result is the same as a serial update
+struct DeferredEffects {
+    struct Resize {
+        uint32_t source; // index of the object that asked, for ordering
+        uint32_t sequence; // position in this queue, ties between requests from the same object
+        int top, bottom, left, right;
+        int initialSpeed;
+        float duration;
+    };
+
+    uint32_t source = 0; // object currently updating on this thread, set by the game manager
+    std::vector<Resize> resizes;
+    bool gameOver = false;
+
+    void requestResize(int top, int bottom, int left, int right, int initialSpeed, float duration) {
+        resizes.push_back(Resize{source, uint32_t(resizes.size()), top, bottom, left, right, initialSpeed, duration});
+    }
+    void requestGameOver() { gameOver = true; }
+
+    void clear() {
+        resizes.clear(); // keeps its capacity
+        gameOver = false;
+    }
+};
@@ -2,22 +2,38 @@
 #define ENTITIES_H
 
 #include "utils.h"
+#include "frame_arena.h"
+#include "shape_library.h"
+#include "frame_clock.h"
+#include "sim_context.h"
+#include "sim_lod.h"
+#include "kinematics.h"
 #include <SDL.h>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <atomic>
 
 class Window;
 class Player; // Forward declaration
+struct RenderEntity;
+struct RenderSnapshot;
+class StateWriter;
+class StateReader;
 
 class GameObject {
     private:
-        static std::vector<Vector2D> getAxes(const std::vector<Vector2D>& vertices);
+        static FrameVector<Vector2D> getAxes(const std::vector<Vector2D>& vertices);
         static void project(
             const std::vector<Vector2D>& vertices,
             const Vector2D& axis,
             float& minOut, float& maxOut
         );
+        static bool overlapsOnAxes(
+            const std::vector<Vector2D>& axes,
+            const std::vector<Vector2D>& vertices1,
+            const std::vector<Vector2D>& vertices2
+        );
 
     public:
         enum class Scope {
@@ -29,15 +45,28 @@ class GameObject {
         Vector2D position; // center coords btw
         Vector2D dimensions;
         Vector2D direction;
-        std::vector<Vector2D> vertices;
-        std::vector<Vector2D> localVertices;
+        std::vector<Vector2D> vertices; // world space, rebuilt from the shape prototype
+        std::vector<Vector2D> axes;     // world space edge normals for sat
+        const ShapePrototype* shape = nullptr; // shared local-space hull
         float angle; // rad
+
+        // state at the start of the current sim step, rendering blends from this to the current one
+        Vector2D previousPosition;
+        float previousAngle;
+
         Uint8 color[4]; // RGBA 
                         // textures are plain white, color is used for tinting
         SDL_Texture* texture;
         Scope scope;
         bool isActive;
+        std::atomic<bool> despawnQueued{false}; // set by the command buffer, cleared on reactivation
         int speed; // pixels per second
+        SimContext* context = nullptr; // set by the game manager before the object goes live
+        Pcg32 random; // own stream, so update() can run on any thread without touching context->rng
+        SimLod lod = SimLod::Full; // picked by the game manager from the distance to the window
+        float lodTime = 0.0f;      // step time piled up since the last update, handed over as one big step
+        Motion motion;             // what update() wants to move by, see kinematics.h
+        friend class Kinematics;
     
     public:
         enum class ObjectType {
@@ -55,20 +84,53 @@ class GameObject {
         virtual ~GameObject();
 
         // core functionalities
-        virtual void draw(SDL_Renderer* renderer) = 0;
-        virtual void update(float deltaTime) = 0;
+        // the clock is the only gameplay time there is, don't ask SDL
+        virtual void update(const FrameClock& clock) = 0;
+
+        // rendering happens on the main thread from a snapshot, never from the live object
+        // returns false if there's nothing to draw this frame
+        virtual bool writeSnapshot(RenderEntity& out) const;
+        void writeDebugHull(RenderEntity& out, RenderSnapshot& snapshot) const;
+
+        // rewind / restart, every field that changes during play goes through here
+        // window and player pointers aren't state, the game manager wires those up on load
+        virtual void saveState(StateWriter& out) const;
+        virtual void loadState(StateReader& in);
 
         // positions and movement
         virtual void setPosition(const Vector2D& pos);
         virtual void setDirection(const Vector2D& dir);
         virtual void move(Vector2D delta);
         virtual void setSpeed(int speed) {this->speed = speed;}
+        // velocities and knockback, applied by the integrator after the update pass
+        Motion& getMotion() { return motion; }
+        const Motion& getMotion() const { return motion; }
 
         // dimensions and rotation
         virtual void setDimensions(const Vector2D& dims);
         virtual void setAngle(float angle);
         virtual void rotate(float dAngle); 
 
+        // fixed timestep interpolation
+        void storePreviousState() { previousPosition = position; previousAngle = angle; }
+        void snapPreviousState() { storePreviousState(); } // after teleports, so nothing slides across the screen
+
+        void setContext(SimContext* context) { this->context = context; }
+        void setRandom(const Pcg32& stream) { random = stream; }
+
+        // scripts and tweens for whatever the object's state says is pending
+        // called when it goes live and again after a load (the scheduler and the tweens start out empty then)
+        virtual void scheduleTimers() {}
+        // on the way out, nothing may fire at or resume for a removed object
+        virtual void cancelTimers() {}
+
+        // simulation lod, see sim_lod.h
+        virtual bool supportsLod() const { return false; }
+        SimLod getLod() const { return lod; }
+        void setLod(SimLod lod) { this->lod = lod; }
+        void addLodTime(float dt) { lodTime += dt; }
+        float takeLodTime() { float dt = lodTime; lodTime = 0.0f; return dt; }
+
         // state
         virtual void setActive(bool active);
         virtual void setScope(Scope scope);
@@ -79,11 +141,19 @@ class GameObject {
 
         // getters
         virtual Vector2D getPosition() const;
+        // as of the start of the step, what other objects should read while updates run in parallel
+        Vector2D getPreviousPosition() const { return previousPosition; }
         virtual Vector2D getDirection() const;
         virtual Vector2D getDimensions() const;
         virtual float getAngle() const;
         virtual Scope getScope() const;
         virtual bool getActive() const;
+
+        // deferred despawn, returns false if one was already queued
+        bool markForDespawn() { return !despawnQueued.exchange(true); }
+        bool isDespawnQueued() const { return despawnQueued.load(std::memory_order_relaxed); }
+        // active and not about to be removed, what collision handling should look at
+        bool isAlive() const { return isActive && !isDespawnQueued(); }
         virtual ObjectType getType() const {return ObjectType::Generic;}
 
         // specifically for circular objects
@@ -96,6 +166,8 @@ class GameObject {
         virtual void setCollisionVertices(const std::vector<Vector2D>& vertices);
         virtual void initRectangleCollision();
         virtual void initCircleCollision();
+        void setShape(ShapeKind kind);
+        float getBoundingRadius() const;
         
         // sat api
         bool checkCollision(const GameObject& other);
@@ -129,9 +201,11 @@ public:
                Window* window);
     ~Projectile();
 
-    void draw(SDL_Renderer* renderer) override;
-    void update(float deltaTime) override;
+    void update(const FrameClock& clock) override;
+    bool writeSnapshot(RenderEntity& out) const override;
     ObjectType getType() const override {return ObjectType::Projectile;}
+    void saveState(StateWriter& out) const override;
+    void loadState(StateReader& in) override;
 
     void setDamage(float damage) {this->damage = damage;}
     float getDamage() const {return damage;}
@@ -144,10 +218,12 @@ class Triangle : public GameObject {
         Player* homingTarget; // back pointer
         // this is a bit of a mess
         float health, maxHealth, score;
-        float lastHitTime = 0.0f;
+        uint64_t flashStartTick = 0; // sim tick of the last hit, 0 = never hit
+        float flashAmount = 0.0f; // how white, 1 right after a hit, tweened back to 0
+        TweenHandle flashTween;
         float whiteFlashDuration = 0.05f; // seconds
         void initTriangleCollision();
-        int spinDirection; // 1: clockwise, -1: anticlockwise
+        int spinDirection = 1; // 1: clockwise, -1: anticlockwise, picked by the spawner
     
     public:
         Triangle(Vector2D pos,
@@ -161,21 +237,24 @@ class Triangle : public GameObject {
                  float health = 50.0f);
         ~Triangle();
 
-        void draw(SDL_Renderer* renderer) override;
-        void update(float deltaTime) override;
+        void update(const FrameClock& clock) override;
+        bool writeSnapshot(RenderEntity& out) const override;
         ObjectType getType() const override {return ObjectType::Triangle;}
+        bool supportsLod() const override {return scope == Scope::GLOBAL;}
+        void saveState(StateWriter& out) const override;
+        void loadState(StateReader& in) override;
+        void scheduleTimers() override;
+        void cancelTimers() override;
 
         void setHealth(float health) {this->health = std::clamp(health, 0.0f, maxHealth);}
         void setScore(float score) {this->score = score;}
-        void setLastHitTime(float time) {lastHitTime = time;}
+        void flash(const FrameClock& clock); // white, fading back to the normal color
+        void setSpinDirection(int direction) {spinDirection = direction;}
 
         void changeHealthBy(float delta);
 
         float getHealth() const {return health;}
         float getScore() const {return score;}
-
-        void drawCollisionVertices(SDL_Renderer* renderer) const;
-        void drawHealthBar(SDL_Renderer* renderer) const;
 };
 
 // ---- beam -------------------------------------------------
@@ -202,7 +281,11 @@ class Beam : public GameObject {
                                 // (expands until touching the other edge)
 
         float activeDuration;   // How long the beam stays at full size
+        uint64_t activeUntil = 0; // sim tick the active state ends on
         float fadeDuration;     // How long the beam takes to fade out
+        uint64_t fadeStartTick = 0; // sim tick the fade started on
+        float opacity = 1.0f;   // 1 until the fade tweens it down to 0
+        TweenHandle fadeTween;
         
         int direction; // 0=bottom, 1=top, 2=right, 3=left
         int startEdge; // 0=top, 1=bottom, 2=left, 3=right
@@ -214,6 +297,10 @@ class Beam : public GameObject {
         
         // initrectanglecollision already exist, since the beam is just a long rectangle, might as well use that
 
+        ScriptHandle script;
+        ScriptTask run();
+        void warningStep(); // stretch once, then stay glued to the window edge
+        void expandStep(float progress);
     
     public:
         Beam(Vector2D pos, Vector2D dims, /*Vector2D vel,*/ Scope scope,
@@ -223,9 +310,10 @@ class Beam : public GameObject {
         ~Beam();
         
         // Override virtual methods
-        void update(float deltaTime) override;
-        void draw(SDL_Renderer* renderer) override;
-        void drawCollisionVertices(SDL_Renderer* renderer) const;
+        void update(const FrameClock& clock) override;
+        bool writeSnapshot(RenderEntity& out) const override;
+        void scheduleTimers() override;
+        void cancelTimers() override;
 
         // helper
         void expandTop(float delta);
@@ -236,9 +324,13 @@ class Beam : public GameObject {
         
         // Type identification
         GameObject::ObjectType getType() const override { return ObjectType::Beam; }
+        void saveState(StateWriter& out) const override;
+        void loadState(StateReader& in) override;
         
         // State access
         BeamState getState() const { return state; }
+        bool isVertical() const { return direction == 0 || direction == 1; } // sweeps a column, not a row
+        float getBeamWidth() const { return beamWidth; }
 };
 
 // ---- Pentagon -------------------------------------------------
@@ -247,7 +339,9 @@ protected:
     Window* window;
     Player* player; // Reference to player for collision handling
     float health, maxHealth, score;
-    float lastHitTime = 0.0f;
+    uint64_t flashStartTick = 0; // sim tick of the last hit, 0 = never hit
+    float flashAmount = 0.0f; // how white, 1 right after a hit, tweened back to 0
+    TweenHandle flashTween;
     float whiteFlashDuration = 0.05f; // seconds
     void initPentagonCollision();
 
@@ -260,19 +354,22 @@ public:
              float health = 500.0f);
     ~Pentagon();
 
-    void draw(SDL_Renderer* renderer) override;
-    void update(float deltaTime) override;
+    void update(const FrameClock& clock) override;
+    bool writeSnapshot(RenderEntity& out) const override;
     ObjectType getType() const override {return ObjectType::Pentagon;}
+    bool supportsLod() const override {return scope == Scope::GLOBAL;}
+    void saveState(StateWriter& out) const override;
+    void loadState(StateReader& in) override;
+    void scheduleTimers() override;
+    void cancelTimers() override;
 
     void setHealth(float health) {this->health = std::clamp(health, 0.0f, maxHealth);}
-    void setLastHitTime(float time) {lastHitTime = time;}
+    void flash(const FrameClock& clock); // white, fading back to the normal color
     void changeHealthBy(float delta);
 
     float getScore() {return score;}
 
     float getHealth() const {return health;}
-    void drawCollisionVertices(SDL_Renderer* renderer) const;
-    void drawHealthBar(SDL_Renderer* renderer) const;
 };
 
 #endif // ENTITIES_H
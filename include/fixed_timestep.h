@@ -0,0 +1,29 @@
+#pragma once
+
+// fixed-rate simulation clock
+// real frame time goes into an accumulator, the simulation then runs as many whole steps as fit,
+// whatever is left over becomes the interpolation factor for rendering
+//
+//   timestep.addFrameTime(dt);
+//   while (timestep.consumeStep()) { update(timestep.getStep()); }
+//   draw(timestep.getAlpha());
+class FixedTimestep {
+private:
+    float step;          // seconds per simulation step
+    float accumulator = 0.0f;
+    int maxCatchUpSteps; // cap so one long hitch doesn't turn into a spiral of death
+    int stepsThisFrame = 0;
+    int droppedSteps = 0; // steps thrown away by the cap, for debugging
+
+public:
+    explicit FixedTimestep(float hz = 120.0f, int maxCatchUpSteps = 8);
+
+    void addFrameTime(float frameTime);
+    bool consumeStep();
+
+    float getStep() const { return step; }
+    float getAlpha() const { return accumulator / step; } // [0, 1) between the last two sim states
+    int getStepsThisFrame() const { return stepsThisFrame; }
+    int getDroppedSteps() const { return droppedSteps; }
+    void reset() { accumulator = 0.0f; }
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdarg>
+#include <memory>
+#include <string>
+#include <vector>
+
+// per-frame bump allocator
+// everything handed out here is thrown away together when reset() is called at the top of the main loop,
+// so transient per-frame work (strings, SAT axes, temp lists) never has to go through malloc
+class FrameArena {
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0; // block currently being filled
+    size_t offset = 0;  // bump pointer inside that block
+    size_t usedBytes = 0;
+    size_t peakBytes = 0;
+
+    void addBlock(size_t minSize);
+
+public:
+    explicit FrameArena(size_t blockSize = 256 * 1024);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    // invalidates everything allocated since the last reset
+    // if the frame spilled into extra blocks they get merged into one big block,
+    // so after a couple of frames the steady state is a single block and zero mallocs
+    void reset();
+
+    size_t used() const { return usedBytes; }
+    size_t peak() const { return peakBytes; }
+    size_t capacity() const;
+};
+
+// the calling thread's arena
+FrameArena& frameArena();
+
+// printf into frame memory, the result is valid until the next reset
+const char* frameFormat(const char* format, ...);
+
+// stl adapter, deallocate is a no-op since the whole arena is dropped at once
+template <typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator() noexcept = default;
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(frameArena().allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T*, size_t) noexcept {}
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>&) const noexcept { return false; }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// the only source of gameplay time
+// advanced once per sim step by the game manager and handed down through every update call,
+// so nothing in gameplay code asks the os what time it is and the sim can run at any speed
+struct FrameClock {
+    uint64_t tick = 0;      // steps since the game (re)started
+    float deltaTime = 0.0f; // length of the current step
+    double time = 0.0;      // seconds of game time at the end of the current step
+
+    void advance(float dt) {
+        tick++;
+        deltaTime = dt;
+        time += dt;
+    }
+    void reset() { *this = FrameClock(); }
+
+    float now() const { return float(time); }
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <ostream>
+
+// paces the render loop on the performance counter instead of SDL_GetTicks + SDL_Delay
+// deadlines are absolute (start + n * period), so rounding never accumulates into drift,
+// and the last bit before a deadline is spun instead of slept since sleeps overshoot by a millisecond or more
+//
+//   pacer.start();
+//   while (running) { ...; present; pacer.waitForNextFrame(); }
+class FramePacer {
+public:
+    enum class Mode {
+        Capped,   // sleep + spin to the target rate
+        VSync,    // present() already blocks, only measure
+        Uncapped  // as fast as possible, only measure
+    };
+
+private:
+    Mode mode;
+    Uint64 frequency;
+    Uint64 period;      // counter ticks per frame
+    Uint64 spinMargin;  // sleep until this close to the deadline, spin the rest
+    Uint64 nextDeadline = 0;
+    Uint64 lastFrameEnd = 0;
+
+    // stats, frame time = counter delta between two waitForNextFrame() returns
+    uint64_t frames = 0;
+    double frameTimeMean = 0.0; // seconds, welford running mean/variance
+    double frameTimeM2 = 0.0;
+    double overshootTotal = 0.0; // seconds past the deadline, capped mode only
+    double overshootMax = 0.0;
+    uint64_t missedDeadlines = 0; // frames that started more than a whole period late
+
+    void recordFrame(Uint64 now);
+
+public:
+    explicit FramePacer(int fps, Mode mode = Mode::Capped, float spinMarginMs = 2.0f);
+
+    void start();
+    void waitForNextFrame();
+
+    Mode getMode() const { return mode; }
+    uint64_t getFrames() const { return frames; }
+    double getMeanFrameTime() const { return frameTimeMean; }
+    double getFrameTimeStdDev() const;
+    double getMeanOvershoot() const { return frames ? overshootTotal / frames : 0.0; }
+    double getMaxOvershoot() const { return overshootMax; }
+    uint64_t getMissedDeadlines() const { return missedDeadlines; }
+
+    void report(std::ostream& out) const;
+};
@@ -7,8 +7,16 @@
 #include "entities.h"
 #include "window.h"
 #include "collision_manager.h"
+#include "command_buffer.h"
+#include "sim_context.h"
+#include "frame_clock.h"
+#include "job_system.h"
+#include "spawn_director.h"
+#include "quality_governor.h"
+#include "kinematics.h"
 
 class Player;
+struct RenderSnapshot;
 
 // Game state enum to track current game state
 enum class GameState {
@@ -22,12 +30,9 @@ class GameManager {
 private:
     Window* window;
     std::vector<std::unique_ptr<GameObject>> gameObjects;
-    std::mt19937 rng;
-    float spawnTimer;
-    float spawnInterval;
-    float beamTimer; 
-    float beamInterval;
-    
+    SimContext context; // the rng, see sim_context.h
+    FrameClock clock;   // game time, advanced once per update()
+    uint64_t stateHash = 0; // of the last step, only kept up to date in deterministic mode
     // Game state management
     GameState gameState = GameState::RUNNING;
     float gameOverDelay = 2.0f;
@@ -36,9 +41,28 @@ private:
     // Collision manager
     CollisionManager collisionManager;
 
-    // Pentagon spawn variables
-    float pentagonTimer = 0.0f;
-    float pentagonInterval = 15.0f;
+    // deferred spawns/despawns, applied once at the end of update()
+    CommandBuffer commandBuffer;
+    std::vector<GameObject*> spawnBatch; // reused every flush
+
+    // wave timers, spawn budget and placement
+    SpawnDirector spawnDirector;
+
+    // entity updates are spread over this when set, otherwise they run on the calling thread
+    JobSystem* jobs = nullptr;
+    static constexpr size_t entityGrain = 32; // objects per range, less than this isn't worth a handoff
+    SimLodSettings lodSettings;
+    int lodCounts[3] = {}; // objects per tier last step
+    QualityKnobs quality;  // see setQuality()
+    Kinematics kinematics; // moves everything after the update pass
+    void updateEntities();
+    void applyDeferredEffects(); // what the entities asked for while updating, in object order
+
+    // world as it was right after setup, restartGame() just loads this
+    std::vector<uint8_t> initialState;
+
+    // empty object of the given type for loadWorld to fill in
+    std::unique_ptr<GameObject> createBlankObject(GameObject::ObjectType type, Player* player);
 
 public:
     GameManager(Window* window);
@@ -50,21 +74,47 @@ public:
     void triggerGameOver();
     GameState getGameState() const { return gameState; }
     bool isPaused() const { return gameState == GameState::PAUSED || gameState == GameState::GAME_OVER; }
+
+    // deterministic mode: fixed seed, the world gets hashed after every step
+    void setSeed(uint64_t seed);
+    SimContext& getContext() { return context; }
+    Window* getWindow() { return window; }
+    SpawnDirector& getSpawnDirector() { return spawnDirector; }
+    SimLodSettings& getLodSettings() { return lodSettings; }
+    int getLodCount(SimLod lod) const { return lodCounts[int(lod)]; }
+    Kinematics& getKinematics() { return kinematics; } // decay profiles
+    // from the quality governor, between steps. render knobs always apply, the ones that change gameplay
+    // (spawn rate, cosmetics, lod) are ignored in deterministic mode so seeds, hashes and recordings still line up
+    void setQuality(const QualityKnobs& knobs);
+    const QualityKnobs& getQuality() const { return quality; }
+    void setJobSystem(JobSystem* jobs); // before the first update
+    const FrameClock& getClock() const { return clock; }
+    uint64_t computeStateHash() const;
+    uint64_t getStateHash() const { return stateHash; }
+
+    // whole world <-> flat bytes, for the rewind buffer and restarts
+    // out is cleared first but keeps its capacity, so saving every tick doesn't allocate
+    void saveWorld(std::vector<uint8_t>& out) const;
+    bool loadWorld(const uint8_t* data, size_t size);
+    void captureInitialState(); // call once after setup, before the first update
+    Player* findPlayer();
     
-    void addObject(std::unique_ptr<GameObject> obj);
+    void addObject(std::unique_ptr<GameObject> obj); // immediate, for setup outside of the frame
+    Player* createPlayer(); // centered in the window, added immediately
+    void despawn(GameObject* obj) { commandBuffer.despawn(obj); }
+    CommandBuffer& getCommandBuffer() { return commandBuffer; }
+    void flushCommands();
     void handleInput(const SDL_Event& event, Player* player);
 
     // Spawn methods
     void spawnTriangle(Vector2D pos, Vector2D dir, Player* target = nullptr);
     void spawnProjectile(Vector2D pos, Vector2D dir, int speed);
-    void spawnRandomEnemy(Player* target = nullptr);
     void spawnBeam(Player* target);
     void spawnPentagon(Vector2D pos, Player* player);
-    void spawnPentagonGroup(Player* player);
 
     // Game loop methods
     void update(float deltaTime);
-    void draw(SDL_Renderer* renderer);
+    void buildSnapshot(RenderSnapshot& snapshot); // copy out what the main thread needs to draw
     void cleanupInactiveObjects();
     
     // Collision handling
@@ -7,12 +7,11 @@ extern int windowWidth;
 extern int windowHeight;
 extern int screenFPS;
 extern int screenTicksPerFrame;
+extern int simulationHz;       // fixed simulation rate, independent of screenFPS
+extern int maxCatchUpSteps;    // sim steps allowed per rendered frame before time is dropped
 extern int displayWidth;
 extern int displayHeight;
+extern bool debugCollisionHulls; // draw collision hulls on top of everything
 
-// Keyboard state
-extern std::map<std::string, bool> keyState;
-
-// Mouse state
-extern std::map<std::string, bool> mouseState;
-extern int mouseX, mouseY;
\ No newline at end of file
+// everything here is settings, read only once the game is running
+// anything that changes during play belongs to a game instance (SimContext, Window)
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// runs the whole simulation (spawning, entities, collisions, window shrinking) with no display,
+// as fast as it will go. for benchmarks and soak tests on machines without a screen
+struct HeadlessOptions {
+    uint64_t ticks = 36000; // 5 minutes of game time at 120hz
+    bool seeded = false;
+    uint64_t seed = 0;
+    const char* hashLogPath = nullptr; // same "tick hash" format as the windowed run
+    float rewindSeconds = 0.0f; // > 0: record rewind history, at the end restore the oldest tick and
+                                // re-simulate to check the world comes out identical
+    size_t rewindBudget = 64 * 1024 * 1024;
+    bool simLod = true; // false: everything at full rate, for comparing against
+    int workers = -1; // entity update threads, -1 = one per spare core, 0 = all on the calling thread
+    const char* replayPath = nullptr; // play an input recording to its end instead, exit 1 if the state differs
+    size_t batchWorlds = 0; // > 0: run this many independent sessions side by side instead (seeds seed, seed+1, ...),
+                            // each one until game over or ticks
+    uint64_t batchSync = 1; // steps per world between lockstep points
+    float qualityBudget = 0.0f; // seconds per step, > 0: run the quality governor on step times
+    float autopilot = -1.0f; // >= 0: the autopilot plays (every batch world too), at this intensity
+};
+
+// prints timing + the final state hash to stdout, returns the process exit code
+int runHeadless(const HeadlessOptions& options);
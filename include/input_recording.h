@@ -0,0 +1,79 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// compact binary recording of the input the simulation sees, for reproducing a run exactly
+//
+// file layout (little endian):
+//   header  "GRIN" u16 version, u64 seed, u32 sim hz, i32 display w, i32 display h,
+//           f32 rewind seconds, u64 rewind budget
+//   events  varint step delta, u8 kind, payload (key: varint keycode / mouse: u8 button, zigzag varint x, y)
+//   footer  kind 0xff, varint step delta to the last step, u64 state hash after it
+//
+// steps count every fixed sim step since startup (paused or not), so restarts don't reset them
+// only the event kinds the sim reacts to are kept: key down/up and mouse button down/up
+struct RecordingHeader {
+    uint64_t seed = 0;
+    uint32_t simulationHz = 0;
+    int32_t displayWidth = 0;
+    int32_t displayHeight = 0;
+    // backspace rewinds out of the rewind history, so a replay needs the same one (0 seconds = there was none)
+    float rewindSeconds = 0.0f;
+    uint64_t rewindBudget = 0;
+};
+
+class InputRecorder {
+private:
+    std::ofstream out;
+    uint64_t lastStep = 0;
+    uint64_t eventCount = 0;
+    std::vector<uint8_t> buffer; // one record, reused
+
+public:
+    bool open(const std::string& path, const RecordingHeader& header);
+    bool isOpen() const { return out.is_open(); }
+
+    // step = sim steps completed before the event was handled
+    void record(uint64_t step, const SDL_Event& event);
+    void finish(uint64_t step, uint64_t stateHash);
+    uint64_t getEventCount() const { return eventCount; }
+};
+
+class InputReplay {
+public:
+    struct RecordedEvent {
+        uint64_t step;
+        SDL_Event event;
+    };
+
+private:
+    RecordingHeader header;
+    std::vector<RecordedEvent> events;
+    size_t next = 0;
+    uint64_t endStep = 0;
+    uint64_t finalHash = 0;
+    bool hasFooter = false; // recording was closed cleanly
+
+public:
+    bool open(const std::string& path); // reads the whole file
+
+    const RecordingHeader& getHeader() const { return header; }
+    uint64_t getEndStep() const { return endStep; }
+    uint64_t getFinalHash() const { return finalHash; }
+    bool isComplete() const { return hasFooter; }
+    size_t getEventCount() const { return events.size(); }
+    bool finished(uint64_t step) const { return next >= events.size() && step >= endStep; }
+
+    // hands every event recorded for this step to fn, in order
+    template <typename Fn>
+    void feed(uint64_t step, Fn&& fn) {
+        while (next < events.size() && events[next].step <= step) {
+            fn(events[next].event);
+            next++;
+        }
+    }
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <SDL.h>
+
+// what the player is holding down right now, one per game (used to be globals, which capped a process at one game)
+// fed from SDL events by whoever drives the game: the sim thread, a replay, the batch runner
+struct InputState {
+    bool up = false, down = false, left = false, right = false;
+    bool j = false; // test key
+    bool mouseLeft = false, mouseMiddle = false, mouseRight = false;
+    int mouseX = 0, mouseY = 0;
+
+    void clear() { *this = InputState(); }
+};
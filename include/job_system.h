@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// work-stealing thread pool, just enough of one for parallel-for over entity ranges
+// every thread (the workers plus whoever calls parallelFor, slot 0) has its own deque of ranges:
+// the owner pops from the back and keeps splitting what it pops in half, idle threads steal from
+// the front of someone else's deque, so they grab the big halves and the owner keeps the cache-warm small ones
+//
+// one thread drives it (the sim thread), parallelFor isn't reentrant
+class JobSystem {
+public:
+    using RangeFn = void (*)(void* data, size_t begin, size_t end);
+
+private:
+    struct Job {
+        size_t begin, end;
+    };
+
+    // a range split in half gets pushed back, so the depth is log2(count / grain), 64 is plenty
+    static constexpr size_t dequeCapacity = 64;
+
+    struct Deque {
+        std::mutex mutex;
+        Job jobs[dequeCapacity];
+        size_t head = 0, tail = 0; // [head, tail) in a ring, head = steal end, tail = owner end
+    };
+
+    std::vector<std::unique_ptr<Deque>> deques; // slot 0 = calling thread, 1..n = workers
+    std::vector<std::thread> workers;
+
+    // the batch currently running, set by parallelFor before anyone is woken
+    RangeFn batchFn = nullptr;
+    void* batchData = nullptr;
+    size_t batchGrain = 1;
+    std::atomic<size_t> pendingItems{0};
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    uint64_t batchEpoch = 0; // bumped per batch, guarded by wakeMutex
+    bool stopping = false;
+
+    // stats
+    std::atomic<uint64_t> steals{0};
+    uint64_t batches = 0;
+    uint64_t inlineBatches = 0;
+
+    bool push(unsigned slot, Job job);
+    bool pop(unsigned slot, Job& out);
+    bool steal(unsigned thief, Job& out);
+    bool findWork(unsigned slot, Job& out);
+    void execute(unsigned slot, Job job);
+    void workerLoop(unsigned slot);
+    void run(size_t count, size_t grain, RangeFn fn, void* data);
+
+    template <typename Fn>
+    static void trampoline(void* data, size_t begin, size_t end) { (*static_cast<Fn*>(data))(begin, end); }
+
+public:
+    // 0 workers = everything runs on the calling thread
+    explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // everything but the main and sim threads
+    static unsigned defaultWorkerCount();
+
+    unsigned getWorkerCount() const { return unsigned(workers.size()); }
+    unsigned getSlotCount() const { return unsigned(deques.size()); } // workers + the calling thread
+
+    // which deque the calling thread owns, 0 for anything that isn't a worker
+    // per-thread scratch (see DeferredEffects) is indexed by this
+    static unsigned currentSlot();
+
+    // calls fn(begin, end) over disjoint ranges covering [0, count), about grain items each
+    // blocks until every range is done, the calling thread helps out in the meantime
+    template <typename Fn>
+    void parallelFor(size_t count, size_t grain, Fn&& fn) {
+        using F = std::remove_reference_t<Fn>;
+        run(count, grain, &trampoline<F>, const_cast<void*>(static_cast<const void*>(&fn)));
+    }
+
+    uint64_t getSteals() const { return steals.load(std::memory_order_relaxed); }
+    uint64_t getBatches() const { return batches; }
+    uint64_t getInlineBatches() const { return inlineBatches; }
+};
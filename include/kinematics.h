@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "utils.h"
+
+class GameObject;
+class JobSystem;
+
+// how an object's drift (what's left of past impulses) dies off, see Kinematics
+enum class DecayProfile : uint8_t {
+    None,      // never decays, nothing without a profile gets impulses anyway
+    Knockback, // the player's trailing knockback
+    Count
+};
+
+struct DecaySettings {
+    float rate = 0.0f;   // per second, drift *= max(0, 1 - rate * dt)
+    float cutoff = 0.0f; // pixels per second, anything slower stops dead
+};
+
+// per object motion, written by update() and collision handling instead of moving the object right there
+// Kinematics picks it up after the update pass and moves everything in one go
+struct Motion {
+    Vector2D velocity{0, 0}; // pixels per second, this step only: update() sets it, the integrator uses it up
+    float spin = 0.0f;       // radians per second, same deal
+    Vector2D impulse{0, 0};  // pixels per second, lands in drift at the next integration
+    Vector2D drift{0, 0};    // decays per profile
+    Vector2D burst{0, 0};    // held at full strength for burstTime, the quick first shove of a knockback
+    float burstTime = 0.0f;
+    DecayProfile profile = DecayProfile::None;
+
+    // where the position ends up clamped to, set per step (the player keeps itself in the window with it)
+    bool clamped = false;
+    Vector2D clampMin{0, 0}, clampMax{0, 0};
+
+    void push(Vector2D velocity) { impulse += velocity; }
+    void kick(Vector2D velocity, float seconds) { burst = velocity; burstTime = seconds; }
+    void stop() { impulse = drift = burst = Vector2D(0, 0); burstTime = 0.0f; }
+};
+
+// semi-implicit euler over every object that stepped, kept as one array per component so the loop vectorizes:
+//   drift = (drift + impulse) * damping, cut off below the profile's cutoff
+//   position += (velocity + drift) * dt + burst * min(burstTime, dt), then clamped
+// then every object that moved or turned gets its hull transformed once, instead of once per move()/rotate()
+//
+// slots are object indices, load() from the update pass writes only its own so it's fine from any thread
+class Kinematics {
+private:
+    DecaySettings profiles[size_t(DecayProfile::Count)];
+
+    std::vector<GameObject*> objects; // null = didn't step
+    std::vector<float> dt;
+    std::vector<float> px, py, angle;
+    std::vector<float> vx, vy, spin;
+    std::vector<float> ix, iy;
+    std::vector<float> dx, dy;
+    std::vector<float> damping, cutoffSquared;
+    std::vector<float> bx, by, burstTime;
+    std::vector<float> minX, minY, maxX, maxY;
+
+    void integrate(size_t begin, size_t end);
+    void store(size_t begin, size_t end);
+
+public:
+    Kinematics();
+
+    void setProfile(DecayProfile profile, const DecaySettings& settings) { profiles[size_t(profile)] = settings; }
+    const DecaySettings& getProfile(DecayProfile profile) const { return profiles[size_t(profile)]; }
+
+    // before the update pass, every slot starts out not stepping
+    void reset(size_t count);
+    // after object's update() ran with this dt
+    void load(size_t slot, GameObject& object, float dt);
+    // integrates and writes back, jobs may be null
+    void run(JobSystem* jobs, size_t grain);
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// lock-free multi-producer single-consumer queue
+// producers push onto an intrusive treiber stack with a single cas,
+// the consumer takes the whole list with one exchange and walks it in push order
+template <typename T>
+class MpscQueue {
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head{nullptr};
+
+public:
+    MpscQueue() = default;
+    ~MpscQueue() { clear(); }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // safe from any thread
+    void push(T value) {
+        Node* node = new Node{std::move(value), head.load(std::memory_order_relaxed)};
+        while (!head.compare_exchange_weak(node->next, node,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+            // node->next was refreshed by the failed cas, just retry
+        }
+    }
+
+    // consumer only, calls fn(T&&) for everything pushed so far in fifo order
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        Node* list = head.exchange(nullptr, std::memory_order_acquire);
+
+        // the stack is newest first, flip it
+        Node* reversed = nullptr;
+        while (list) {
+            Node* next = list->next;
+            list->next = reversed;
+            reversed = list;
+            list = next;
+        }
+
+        size_t count = 0;
+        while (reversed) {
+            Node* next = reversed->next;
+            fn(std::move(reversed->value));
+            delete reversed;
+            reversed = next;
+            count++;
+        }
+        return count;
+    }
+
+    // consumer only, drops everything pending
+    void clear() {
+        drain([](T&&) {});
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == nullptr;
+    }
+};
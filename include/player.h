@@ -29,10 +29,9 @@ private:
     int health                              = 20;
     int maxHealth                           = 20;
     int score                               = 0;
-    Vector2D knockbackVelocity{ 0, 0 };
-    Vector2D rapidKnockbackVelocity{ 0, 0 }; // For the rapid phase
     
     // --- knockback parameters (for easier fine tuning) ---
+    // the velocities themselves live in motion, the trailing decay is the Knockback profile (see kinematics.h)
     // phase 1 parameters
     float phaseOneMultiplier               = 0.2f;   // 20% immediate
 
@@ -42,18 +41,23 @@ private:
 
     // phase 3 parameters
     float phaseThreeMultiplier             = 0.1f;   // 10% (less trailing)
-    float rapidKnockbackTimer              = 0.0f;   // helper timer
-    float knockbackDecay                   = 12.0f;   // Decay rate for phase three (higher = faster decay)
-    float knockbackMinThreshold            = 0.1f;   // minimum threshold before resetting to zero
     /// --- end of knockback parameters ---
 
     // uhhh
     float gracePeriod                      = 0.2f;   // seconds 
-    float lastHitTime                      = 0.0f;
+    float lastHitTime                      = -1.0f;  // sim time, negative = never hit
     bool isDying                           = false;  // death animation flag
-    float deathTimer                       = 0.0f;   // time since death
+    uint64_t deathStartTick                = 0;      // sim tick the death animation started on, 0 = not yet
     float deathAnimationDuration           = 1.0f;   // self explanatory
+    float deathFlashPeriod                 = 0.2f;   // red for half of it, faded for the other half
     float redFlashDuration                = 0.05f;   // seconds
+    float deathFlash                       = 1.0f;   // 1 = red, 0 = faded, blinks while dying
+    Vector2D aliveDimensions;                          // what the death animation shrinks from
+    ScriptEvent died;                                  // signalled by startDeathSequence()
+    ScriptHandle deathScript;
+    TweenHandle shrinkXTween, shrinkYTween, deathFlashTween;
+    ScriptTask runDeath();
+    void cancelDeathTweens();
 
     // timing
     float projectileSpeed                  = 1500.0f; // pps
@@ -75,9 +79,9 @@ public:
     void setSpeed(float speed);
     void setHealth(int hp)          { health = hp; }
     int  getHealth() const          { return health; }
-    void changeHealthBy(int delta);
+    void changeHealthBy(int delta, float now); // now = game time, for the grace period
     void resetHealth()              { health = maxHealth; } // Reset health to max
-    void resetDeathState()          { isDying = false; } // Reset death animation state
+    void resetDeathState()          { isDying = false; deathStartTick = 0; lastHitTime = -1.0f; } // Reset death animation state (the sim clock restarts too)
     void setHitTime(float time) { lastHitTime = time; }
     bool isDead() const         { return health <= 0; }
     bool isInDeathAnimation() const { return isDying; }
@@ -85,27 +89,29 @@ public:
     void addScore(int score)         { this->score += score; }
     void resetScore()                { score = 0; } // Reset score to zero
     int  getScore() const            { return score; } 
+    int  getMaxHealth() const        { return maxHealth; }
     
     // death handling
     void startDeathSequence();
-    void updateDeathAnimation(float deltaTime);
     void reinitializeCollision(); // New method to reinitialize collision after restart
 
     // gameplay
-    void updateMovement(const std::map<std::string, bool>& keys,
-                        const SDL_Rect& bounds, float dt);
+    void updateMovement(const InputState& input, const SDL_Rect& bounds);
     void shoot(const std::map<std::string, bool>& mouse,
                std::vector<Projectile>& projectiles,
                int mouseX, int mouseY);
     void applyKnockback(const Vector2D& impulse);
 
     // overrides
-    void draw(SDL_Renderer* renderer) override;
-    void update(float deltaTime) override;
+    void update(const FrameClock& clock) override;
+    bool writeSnapshot(RenderEntity& out) const override;
     GameObject::ObjectType getType() const override { return GameObject::ObjectType::Player; }
+    void saveState(StateWriter& out) const override;
+    void loadState(StateReader& in) override;
+    void scheduleTimers() override;
+    void cancelTimers() override;
 
     // something
     void processEvent(const SDL_Event& event);
     void setGameManager(GameManager* gm) { gameManager = gm; }
-    void drawCollisionVertices(SDL_Renderer* renderer) const;
 };
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// what the game is allowed to spend time on at one quality level
+struct QualityKnobs {
+    float spawnRate = 1.0f;     // wave frequency, 0.5 = waves half as often
+    bool cosmetics = true;      // triangle / pentagon spin and the white hit flash
+    bool healthBars = true;
+    bool debugOverlays = true;  // collision hulls (only if debugCollisionHulls is on in the first place)
+    float lodMargin = 1.0f;     // scales how far outside the window things stay at full rate, see sim_lod.h
+};
+
+// keeps frame work under a budget by turning quality down one level at a time, and back up once there's room again
+// fed one sample per frame (the busy part of it, not the time spent waiting on the pacer). every evaluateEvery
+// samples it looks at the p95 of the last window: over budget steps down straight away, under upRatio of the budget
+// steps up only after upHold evaluations in a row. after a change the window starts over, the old samples were
+// measured at a different level
+//
+// the sim knobs (spawn rate, cosmetics, lod) change gameplay, so a game in deterministic mode only ever gets the
+// render knobs turned down, see GameManager::setQuality()
+class QualityGovernor {
+public:
+    static constexpr int levelCount = 5;
+    static const QualityKnobs levels[levelCount]; // 0 = everything on
+
+    struct Settings {
+        float budget = 1.0f / 60.0f; // seconds
+        float upRatio = 0.7f;        // p95 has to be under budget * upRatio to step back up
+        size_t window = 120;         // samples the percentiles are taken over
+        size_t evaluateEvery = 15;
+        int upHold = 8;              // evaluations, 8 * 15 frames = 2 seconds at 60 fps
+    };
+
+private:
+    Settings settings;
+    std::vector<float> samples; // ring
+    std::vector<float> sorted;  // scratch for nth_element
+    size_t next = 0, filled = 0;
+    size_t sinceEvaluation = 0;
+    int level = 0;
+    int underStreak = 0;
+    float p50 = 0.0f, p95 = 0.0f;
+
+    // stats
+    uint64_t sampleCount = 0;
+    uint64_t changes = 0;
+    uint64_t framesAt[levelCount] = {};
+
+    void evaluate();
+    void setLevel(int newLevel);
+
+public:
+    explicit QualityGovernor(const Settings& settings);
+
+    // returns true if the level changed, pick up the new knobs with getKnobs()
+    bool addSample(float seconds);
+
+    int getLevel() const { return level; }
+    const QualityKnobs& getKnobs() const { return levels[level]; }
+    float getBudget() const { return settings.budget; }
+    float getP50() const { return p50; } // of the window at the last evaluation
+    float getP95() const { return p95; }
+    uint64_t getChanges() const { return changes; }
+
+    void report(std::ostream& out) const;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// small fast generators, everything gameplay rolls goes through one of these
+
+// pcg32 (xsh-rr), 16 bytes of state
+// the increment picks one of 2^63 streams, so every entity / thread can have its own
+// sequence from the same seed without them overlapping
+struct Pcg32 {
+    uint64_t state = 0x853c49e6748fea9bull;
+    uint64_t inc = 0xda3e39cb94b95bdbull;
+
+    Pcg32() = default;
+    Pcg32(uint64_t seed, uint64_t stream) { this->seed(seed, stream); }
+
+    void seed(uint64_t seed, uint64_t stream) {
+        state = 0;
+        inc = (stream << 1) | 1u;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ull + inc;
+        uint32_t xorshifted = uint32_t(((old >> 18) ^ old) >> 27);
+        uint32_t rot = uint32_t(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    uint64_t next64() { return (uint64_t(next()) << 32) | next(); }
+
+    // [0, range), lemire's multiply-shift, only divides in the rare rejection case
+    uint32_t bounded(uint32_t range) {
+        uint64_t m = uint64_t(next()) * range;
+        uint32_t low = uint32_t(m);
+        if (low < range) {
+            uint32_t threshold = (0u - range) % range;
+            while (low < threshold) {
+                m = uint64_t(next()) * range;
+                low = uint32_t(m);
+            }
+        }
+        return uint32_t(m >> 32);
+    }
+
+    // [min, max], inclusive like uniform_int_distribution
+    int range(int min, int max) { return min + int(bounded(uint32_t(max - min) + 1u)); }
+
+    // [0, 1), top 24 bits so every value is exact
+    float unit() { return float(next() >> 8) * (1.0f / 16777216.0f); }
+    float range(float min, float max) { return min + (max - min) * unit(); }
+};
+
+// four xoshiro128+ generators side by side, for filling big arrays of floats in one go
+// the lanes are plain arrays updated in lockstep, only 32-bit adds/shifts/xors, so the loop
+// in fill() turns into sse2/neon without any intrinsics
+struct RandomBatch {
+    static constexpr int lanes = 4;
+    uint32_t s0[lanes], s1[lanes], s2[lanes], s3[lanes];
+
+    void seed(Pcg32& source) {
+        for (int i = 0; i < lanes; i++) {
+            s0[i] = source.next();
+            s1[i] = source.next();
+            s2[i] = source.next();
+            s3[i] = source.next() | 1u; // all-zero state would get stuck
+        }
+    }
+
+    // out[0..count) uniform in [min, max)
+    void fill(float* out, size_t count, float min, float max) {
+        float scale = (max - min) * (1.0f / 16777216.0f);
+        size_t i = 0;
+        float block[lanes];
+        while (i < count) {
+            for (int l = 0; l < lanes; l++) {
+                uint32_t result = s0[l] + s3[l];
+                uint32_t t = s1[l] << 9;
+                s2[l] ^= s0[l];
+                s3[l] ^= s1[l];
+                s1[l] ^= s2[l];
+                s0[l] ^= s3[l];
+                s2[l] ^= t;
+                s3[l] = (s3[l] << 11) | (s3[l] >> 21);
+                block[l] = min + float(result >> 8) * scale;
+            }
+            for (int l = 0; l < lanes && i < count; l++) {
+                out[i++] = block[l];
+            }
+        }
+    }
+};
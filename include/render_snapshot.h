@@ -0,0 +1,91 @@
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+#include "utils.h"
+
+enum class GameState;
+
+// immutable copy of everything the main thread needs to draw one frame
+// the simulation thread fills these and hands them over through a triple buffer,
+// so rendering never touches live game objects
+
+enum class RenderStyle {
+    Sprite,     // texture, tinted and rotated
+    FilledRect  // plain blended rectangle (beams)
+};
+
+struct RenderEntity {
+    RenderStyle style = RenderStyle::Sprite;
+    SDL_Texture* texture = nullptr;
+
+    // state at the previous and the latest sim step, blended at draw time
+    Vector2D previousPosition;
+    Vector2D position;
+    float previousAngle = 0.0f; // rad
+    float angle = 0.0f;
+    bool interpolate = true;
+
+    Vector2D dimensions;
+    Uint8 color[4] = {255, 255, 255, 255}; // tint (sprite) or fill color (rect)
+    float healthRatio = -1.0f;             // < 0 means no health bar
+
+    // collision hull, only filled in when debugCollisionHulls is on
+    int hullOffset = 0;
+    int hullCount = 0;
+};
+
+struct RenderSnapshot {
+    std::vector<RenderEntity> entities;
+    std::vector<Vector2D> debugHulls; // world space, see RenderEntity::hullOffset
+
+    SDL_Rect windowBounds = {0, 0, 0, 0};
+    GameState gameState;
+
+    // hud
+    bool hasPlayer = false;
+    int playerHealth = 0;
+    int playerMaxHealth = 0;
+    int playerScore = 0;
+    int qualityLevel = 0; // what the quality governor has turned down, 0 = nothing
+
+    // timing, for interpolating between publishes
+    uint64_t simStep = 0;
+    float alpha = 0.0f;       // leftover accumulator fraction when this was published
+    float stepSeconds = 0.0f; // length of one sim step
+    Uint64 publishCounter = 0; // SDL_GetPerformanceCounter at publish
+
+    void clear() {
+        // keeps the capacity, snapshots are reused by the triple buffer
+        entities.clear();
+        debugHulls.clear();
+        hasPlayer = false;
+    }
+};
+
+// main thread only
+void drawSnapshot(Window* window, const RenderSnapshot& snapshot, float alpha);
+
+// interpolation factor for a snapshot at the current time
+float snapshotAlpha(const RenderSnapshot& snapshot);
+
+// paused / game over: nothing moves until the sim publishes again, so the frame (dimmed, with the pause text)
+// is drawn once into a texture and only copied back out when the window needs a repaint. main thread only
+class PausedFrame {
+    SDL_Texture* texture = nullptr; // null if the renderer can't render to textures, present() redraws then
+    int width = 0, height = 0;
+    Uint64 publishCounter = 0; // of the snapshot it shows
+    bool valid = false;
+
+public:
+    PausedFrame() = default;
+    PausedFrame(const PausedFrame&) = delete;
+    PausedFrame& operator=(const PausedFrame&) = delete;
+    ~PausedFrame() { release(); }
+
+    // redraws if the snapshot is a different one than last time, returns whether it did
+    bool update(Window* window, const RenderSnapshot& snapshot);
+    void present(Window* window, const RenderSnapshot& snapshot);
+    void release(); // before the renderer goes, or after a device reset (the texture is gone then)
+    void invalidate() { valid = false; } // render targets were reset, the texture's still there but its pixels aren't
+};
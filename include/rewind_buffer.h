@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// ring of per-tick world states (GameManager::saveWorld) for rewinding the last few seconds
+// every keyframeInterval ticks the full state is stored, the ticks in between only keep
+// state XOR keyframe, run-length encoded (most bytes don't change, so it's mostly zero runs)
+// restoring a tick = copy its keyframe + apply one delta, never a chain of them
+class RewindBuffer {
+private:
+    struct Frame {
+        uint64_t tick = 0;
+        bool keyframe = false;
+        size_t keyframeSlot = 0; // slot of the keyframe this delta is against
+        size_t rawSize = 0;      // decoded size
+        std::vector<uint8_t> data; // reused while the frame is live, freed when it's dropped
+    };
+
+    std::vector<Frame> frames; // ring
+    size_t head = 0;           // oldest frame
+    size_t count = 0;
+    int keyframeInterval;
+    size_t memoryBudget;       // bytes actually held by the ring
+    size_t memoryUsed = 0;     // only ever the live frames, whatever's dropped gives its memory back
+
+    bool haveKeyframe = false;
+    size_t lastKeyframeSlot = 0;
+    uint64_t lastKeyframeTick = 0;
+
+    size_t slot(size_t index) const { return (head + index) % frames.size(); }
+    void evictOldestGroup(); // oldest keyframe + the deltas that depend on it
+    void setData(Frame& frame, const uint8_t* data, size_t size);
+    void releaseData(Frame& frame);
+
+    static void encodeDelta(const std::vector<uint8_t>& key, const std::vector<uint8_t>& state, std::vector<uint8_t>& out);
+    static void decodeDelta(const std::vector<uint8_t>& key, const Frame& frame, std::vector<uint8_t>& out);
+
+    std::vector<uint8_t> scratch; // delta encoding
+
+public:
+    // capacity in ticks, memory budget in bytes
+    RewindBuffer(size_t capacityTicks = 600, int keyframeInterval = 60, size_t memoryBudget = 64 * 1024 * 1024);
+
+    // ticks have to go up, after a rewind call truncateAfter() first
+    void record(uint64_t tick, const std::vector<uint8_t>& state);
+    bool restore(uint64_t tick, std::vector<uint8_t>& out) const;
+    void truncateAfter(uint64_t tick);
+    void clear();
+
+    bool empty() const { return count == 0; }
+    uint64_t oldestTick() const { return count ? frames[head].tick : 0; }
+    uint64_t newestTick() const { return count ? frames[slot(count - 1)].tick : 0; }
+    size_t getMemoryUsed() const { return memoryUsed; }
+    size_t countLiveMemory() const; // adds up the live frames, should always come out as getMemoryUsed()
+    size_t getMemoryBudget() const { return memoryBudget; }
+    size_t getFrameCount() const { return count; }
+
+    void report(std::ostream& out) const;
+};
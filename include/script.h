@@ -0,0 +1,167 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <vector>
+#include "timing_wheel.h"
+#include "frame_clock.h"
+
+class ScriptScheduler;
+class ScriptEvent;
+
+// fixed size blocks for coroutine frames, so starting a script is a free list pop and not a malloc
+// a pool per thread, no locking (frames may still be made on one thread and destroyed on another), bigger
+// frames than a block go to the heap
+class ScriptFramePool {
+public:
+    static constexpr size_t blockSize = 512;
+    static constexpr size_t blocksPerChunk = 64;
+
+    static void* allocate(size_t size);
+    static void release(void* frame, size_t size);
+    static size_t getOversized(); // frames that didn't fit a block, bump blockSize if this isn't 0
+};
+
+// a gameplay script, written as a straight line with co_await where it has to wait
+// doesn't run until it's handed to a scheduler with start()
+class ScriptTask {
+public:
+    struct promise_type {
+        ScriptScheduler* scheduler = nullptr;
+        uint32_t slot = 0;
+
+        ScriptTask get_return_object() { return ScriptTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; } // the scheduler destroys it
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new(size_t size) { return ScriptFramePool::allocate(size); }
+        static void operator delete(void* frame, size_t size) { ScriptFramePool::release(frame, size); }
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+private:
+    Handle frame;
+
+public:
+    explicit ScriptTask(Handle frame) : frame(frame) {}
+    ScriptTask(ScriptTask&& other) noexcept : frame(other.frame) { other.frame = nullptr; }
+    ScriptTask(const ScriptTask&) = delete;
+    ScriptTask& operator=(const ScriptTask&) = delete;
+    ~ScriptTask() { if (frame) frame.destroy(); }
+
+    Handle release() { Handle out = frame; frame = nullptr; return out; }
+};
+
+struct ScriptHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// runs scripts on sim ticks
+// sleeping scripts sit on a timing wheel and waiting ones on their event, run() only resumes the ones
+// that are due, so a script costs nothing on the steps it isn't doing anything
+//
+// scripts can't be saved, whoever starts one keeps its progress in saved state and starts it again after
+// a load (written so it picks up from that state). scripts due on the same tick run in no particular
+// order, two of them must not depend on each other. sim thread only
+class ScriptScheduler {
+    struct Slot {
+        ScriptTask::Handle frame;
+        uint32_t generation = 0;
+        TimerHandle wake;
+        const ScriptEvent* waitingOn = nullptr;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    TimingWheel wheel;
+    std::vector<ScriptHandle> ready, readyNow; // signalled, resumed on the next run()
+    uint64_t tick = 0;
+    float deltaTime = 0.0f;
+
+    void resume(uint32_t index);
+    void destroy(uint32_t index);
+
+    friend class ScriptEvent;
+    friend struct WaitUntil;
+    void sleepUntil(uint32_t slot, uint64_t due);
+    ScriptHandle waitFor(uint32_t slot, const ScriptEvent* event);
+    void wake(ScriptHandle handle, const ScriptEvent* event);
+
+public:
+    ScriptScheduler() = default;
+    ScriptScheduler(const ScriptScheduler&) = delete;
+    ScriptScheduler& operator=(const ScriptScheduler&) = delete;
+    ~ScriptScheduler();
+
+    // first resumed on the next run()
+    ScriptHandle start(ScriptTask task);
+    // destroys it wherever it's waiting, not from inside the script itself
+    bool stop(ScriptHandle& handle);
+    bool isRunning(const ScriptHandle& handle) const;
+
+    // once per step, resumes everything due on clock.tick
+    void run(const FrameClock& clock);
+    // destroys every script, after a load
+    void reset(uint64_t tick);
+
+    uint64_t now() const { return tick; }
+    float getDeltaTime() const { return deltaTime; } // of the step being run
+    size_t size() const { return slots.size() - freeSlots.size(); }
+};
+
+// co_await waitUntil(tick): wakes on that tick, straight through if it's already here
+struct WaitUntil {
+    uint64_t tick;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(ScriptTask::Handle frame) {
+        ScriptScheduler* scheduler = frame.promise().scheduler;
+        if (tick <= scheduler->now()) return false;
+        scheduler->sleepUntil(frame.promise().slot, tick);
+        return true;
+    }
+    void await_resume() const noexcept {}
+};
+
+inline WaitUntil waitUntil(uint64_t tick) { return WaitUntil{tick}; }
+
+// co_await waitTicks(n), n steps from the one running now
+struct WaitTicks {
+    uint64_t count;
+
+    bool await_ready() const noexcept { return count == 0; }
+    bool await_suspend(ScriptTask::Handle frame) {
+        return WaitUntil{frame.promise().scheduler->now() + count}.await_suspend(frame);
+    }
+    void await_resume() const noexcept {}
+};
+
+inline WaitTicks waitTicks(uint64_t count) { return WaitTicks{count}; }
+inline WaitTicks nextTick() { return WaitTicks{1}; }
+WaitTicks waitSeconds(float seconds); // rounded to whole steps, at least one
+
+// something scripts can co_await, every script waiting on it wakes on the next run() after signal()
+class ScriptEvent {
+    ScriptScheduler* scheduler = nullptr;
+    std::vector<ScriptHandle> waiters; // stopped scripts just don't match any more
+
+    void addWaiter(ScriptTask::Handle frame);
+
+public:
+    void signal();
+    bool hasWaiters() const { return !waiters.empty(); }
+
+    struct Awaiter {
+        ScriptEvent& event;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(ScriptTask::Handle frame) { event.addWaiter(frame); }
+        void await_resume() const noexcept {}
+    };
+    Awaiter operator co_await() { return Awaiter{*this}; }
+};
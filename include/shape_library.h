@@ -0,0 +1,31 @@
+#pragma once
+
+#include "utils.h"
+
+// every collision hull in the game is one of these
+enum class ShapeKind {
+    Rectangle,
+    Circle,
+    Triangle,
+    Pentagon,
+    Count
+};
+
+// immutable local-space hull shared by every entity of the same kind (flyweight)
+// stored for a 1x1 object centered on the origin, entities scale it by their own dimensions,
+// so a beam that resizes every frame still points at the same prototype
+struct ShapePrototype {
+    ShapeKind kind;
+    const Vector2D* vertices; // unit space, clockwise
+    const Vector2D* normals;  // edge normals (edge i -> i+1), not normalized, sat doesn't need it
+    int count;
+    float boundingRadius;     // unit space, multiply by the largest dimension
+};
+
+class ShapeLibrary {
+    public:
+        static const ShapePrototype& get(ShapeKind kind);
+
+        // bounding radius for an object of the given dimensions
+        static float boundingRadius(const ShapePrototype& shape, const Vector2D& dims);
+};
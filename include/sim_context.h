@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "random.h"
+#include "deferred_effects.h"
+#include "job_system.h"
+#include "script.h"
+#include "tween.h"
+#include "input_state.h"
+#include "globals.h"
+#include "swarm_field.h"
+
+// per-game simulation state that every entity can reach
+// this is the only random generator gameplay code is allowed to use (no rand()), entities get their own
+// stream seeded from it when they spawn. time comes from the FrameClock handed to update(), so a run
+// is fully determined by its seed and its inputs
+struct SimContext {
+    uint64_t seed = 0;
+    bool deterministic = false; // fixed seed given on the command line, state hash every tick
+
+    Pcg32 rng;          // spawners, game manager
+    RandomBatch batch;  // bulk rolls, a whole wave at once
+    uint64_t streamsIssued = 0; // entity streams handed out so far, each one gets its own pcg stream
+
+    void reseed(uint64_t newSeed) {
+        seed = newSeed;
+        streamsIssued = 0;
+        rng.seed(seed, 0);
+        batch.seed(rng);
+    }
+
+    float randomFloat(float min, float max) { return rng.range(min, max); }
+    int randomInt(int min, int max) { return rng.range(min, max); }
+    void fillRandom(float* out, size_t count, float min, float max) { batch.fill(out, count, min, max); }
+
+    // an entity's own generator, so entities never touch rng while updating in parallel
+    Pcg32 entityStream() { return Pcg32(rng.next64(), ++streamsIssued); }
+
+    // held keys and mouse, written by whoever drives this game between steps
+    InputState input;
+    // spin and hit flashes, off when the quality governor needs the time (never in deterministic mode)
+    bool cosmetics = true;
+
+    // triangle homing + separation, the game manager rebuilds it before every update pass (see swarm_field.h)
+    SwarmField swarm;
+
+    // one queue per job system slot, see deferred_effects.h
+    std::vector<DeferredEffects> effectQueues = std::vector<DeferredEffects>(1);
+    DeferredEffects& effects() { return effectQueues[JobSystem::currentSlot() % effectQueues.size()]; }
+
+    // gameplay time is in sim ticks
+    static uint64_t ticksFor(float seconds) {
+        return std::max<uint64_t>(1, uint64_t(std::lround(seconds * simulationHz)));
+    }
+
+    // behaviours that read better as a script than a state machine (beams, the wave clock, dying)
+    // only started from serial code (collisions, spawner). not saved: whoever owns a script keeps what it's
+    // waiting for in its own state and starts it again on load
+    ScriptScheduler scripts;
+
+    // fades, flashes, shrinking, anything that's a value going from a to b over time
+    // advanced right after the scripts, same rules again
+    Tweens tweens;
+};
+
+
+// fnv-1a over the bits of whatever gets fed in, floats included
+// two runs with the same seed and inputs have to produce the same value every tick
+struct StateHash {
+    uint64_t value = 14695981039346656037ull;
+
+    void addBytes(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            value ^= bytes[i];
+            value *= 1099511628211ull;
+        }
+    }
+
+    template <typename T>
+    void add(const T& v) {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &v, sizeof(T));
+        addBytes(bytes, sizeof(T));
+    }
+};
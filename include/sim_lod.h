@@ -0,0 +1,50 @@
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include "utils.h"
+
+// simulation level of detail
+// enemies well outside the window can't be seen, so they update less often with a bigger step and skip
+// the purely cosmetic bits (spin, hit flash). the full rate band starts fullMargin pixels outside the window,
+// far enough that anything coming in has been back at full rate for a while before it's visible
+enum class SimLod : uint8_t {
+    Full,    // every step
+    Reduced, // every reducedInterval steps
+    Far      // every farInterval steps
+};
+
+struct SimLodSettings {
+    bool enabled = true;
+    float fullMargin = 300.0f;    // pixels outside the window
+    float reducedMargin = 900.0f;
+    float hysteresis = 50.0f;     // extra distance before dropping a tier, so nothing flips every step on a boundary
+    int reducedInterval = 2;
+    int farInterval = 4;
+
+    int interval(SimLod lod) const {
+        switch (lod) {
+            case SimLod::Reduced: return reducedInterval;
+            case SimLod::Far: return farInterval;
+            default: return 1;
+        }
+    }
+
+    // coming closer switches up straight away, moving away only once past the hysteresis band
+    SimLod pick(SimLod current, float distance) const {
+        SimLod target = distance <= fullMargin ? SimLod::Full
+                      : distance <= reducedMargin ? SimLod::Reduced
+                      : SimLod::Far;
+        if (target <= current) return target;
+        float edge = current == SimLod::Full ? fullMargin : reducedMargin;
+        return distance > edge + hysteresis ? target : current;
+    }
+};
+
+// 0 inside the rect
+inline float distanceToRect(const Vector2D& point, const SDL_Rect& rect) {
+    float dx = std::max({float(rect.x) - point.x, 0.0f, point.x - float(rect.x + rect.w)});
+    float dy = std::max({float(rect.y) - point.y, 0.0f, point.y - float(rect.y + rect.h)});
+    return std::sqrt(dx * dx + dy * dy);
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "game_manager.h"
+#include "fixed_timestep.h"
+#include "mpsc_queue.h"
+#include "render_snapshot.h"
+#include "triple_buffer.h"
+#include "rewind_buffer.h"
+#include "input_recording.h"
+#include "autopilot.h"
+#include "quality_governor.h"
+#include <memory>
+
+class Player;
+
+// runs window + game updates on their own thread at the fixed sim rate
+// the main thread only polls SDL events (forwarded here through a queue) and draws the
+// latest published snapshot, so a slow present can't stall the simulation and vice versa
+class SimulationThread {
+public:
+    // pushed to the main thread's sdl queue when a snapshot it needs to see is published while it's idle
+    static constexpr Uint32 snapshotEvent = SDL_USEREVENT;
+
+private:
+    GameManager& gameManager;
+    Window* window;
+    Player* player; // sim thread only, refreshed on restart
+
+    FixedTimestep timestep;
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    MpscQueue<SDL_Event> inputEvents;
+    // paused with nobody else driving, the thread sleeps here until input comes in instead of ticking over
+    std::mutex idleMutex;
+    std::condition_variable idleWake;
+    bool publishedPaused = false; // the main thread needs waking for every publish while paused + the one after
+    bool shouldIdle() const;
+    void waitForInput();
+    TripleBuffer<RenderSnapshot> snapshots;
+    uint64_t simStep = 0;
+    bool hasSnapshot = false; // main thread
+
+    std::ofstream hashLog; // "tick hash" per step in deterministic mode, diff two of these to compare runs
+    uint64_t lastLoggedTick = 0;
+
+    // backspace while paused steps back a second, only allocated when enabled
+    std::unique_ptr<RewindBuffer> rewind;
+    float rewindSeconds = 0.0f; // what it was enabled with, goes into recordings
+    std::vector<uint8_t> worldScratch;
+    uint64_t lastRecordedTick = 0;
+
+    // input recording / replay, see input_recording.h
+    std::unique_ptr<InputRecorder> recorder;
+    std::unique_ptr<InputReplay> replay; // while set, live input is ignored
+
+    // plays alongside live input (which still works for pausing), recorded like it too
+    std::unique_ptr<Autopilot> autopilot;
+
+    // one sample per rendered frame: the main thread's work or the sim's over the same stretch, whichever is worse
+    std::unique_ptr<QualityGovernor> governor;
+    std::atomic<float> renderWork{0.0f};  // seconds, latest frame
+    std::atomic<uint64_t> renderFrames{0};
+    uint64_t sampledFrames = 0;
+    float simWork = 0.0f; // seconds busy since the last sample
+    void sampleQuality();
+
+    void stepOnce(float dt);
+    void finishReplay();
+    void recordRewind();
+    void rewindBy(uint64_t ticks);
+    void refreshPlayer();
+
+    void run();
+    void handleEvent(const SDL_Event& event);
+    void publishSnapshot();
+
+public:
+    SimulationThread(GameManager& gameManager, Window* window, Player* player);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    void setHashLog(const std::string& path); // before start()
+    void enableRewind(float seconds, size_t memoryBudget); // before start()
+    bool startRecording(const std::string& path);           // before start()
+    // before start(), the game has to be set up from the recording's header (seed, display size) first
+    // the rewind history is set up like the recording's, whatever enableRewind() said
+    void startReplay(std::unique_ptr<InputReplay> recording);
+    const InputReplay* getReplay() const { return replay.get(); }
+    void enableAutopilot(float intensity); // before start(), also turns up the spawner
+    void enableQualityGovernor(const QualityGovernor::Settings& settings); // before start()
+    const QualityGovernor* getGovernor() const { return governor.get(); }
+
+    // no thread: play the whole replay as fast as possible, returns whether the final state matches the recording
+    bool runReplayToEnd();
+    const RewindBuffer* getRewind() const { return rewind.get(); }
+    void start();
+    void stop(); // joins
+
+    // main thread
+    void pushEvent(const SDL_Event& event);
+    // busy time of the frame just drawn, for the quality governor
+    void reportFrameWork(float seconds) {
+        renderWork.store(seconds, std::memory_order_relaxed);
+        renderFrames.fetch_add(1, std::memory_order_release);
+    }
+    // swaps in the newest snapshot if there is one, false until the first publish
+    bool acquireSnapshot();
+    const RenderSnapshot& getSnapshot() const { return snapshots.readBuffer(); }
+};
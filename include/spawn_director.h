@@ -0,0 +1,85 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <ostream>
+#include "utils.h"
+#include "script.h"
+
+class GameManager;
+class Window;
+class Player;
+struct SimContext;
+struct StateHash;
+class StateWriter;
+class StateReader;
+
+// decides when and where enemies spawn
+// a wave script sleeps until the next wave is due and only schedules waves into a small queue, the queue is then released a few objects per step:
+// never more than spawnsPerStep new objects in one step, never more than liveCap enemies alive.
+// placement is constant time as well (no rejection loops), so spawning has a fixed worst case per step
+class SpawnDirector {
+public:
+    enum class WaveKind : uint8_t {
+        Triangles,
+        Beam,
+        Pentagons,
+        Count
+    };
+
+    struct Settings {
+        int spawnsPerStep = 4;
+        int liveCap = 150; // triangles + pentagons + beams
+        float intervals[int(WaveKind::Count)] = {5.0f, 5.0f, 5.0f}; // seconds between waves of each kind
+        float rateScale = 1.0f; // intervals are divided by this, the quality governor turns it down under load
+        float pentagonMinDistance = 500.0f; // from the player
+        int placementAttempts = 3; // random directions to try before falling back to the farthest corner
+    };
+
+private:
+    struct Wave {
+        WaveKind kind;
+        uint8_t remaining;
+        int16_t margin; // triangles: how far off the window edge
+    };
+    static constexpr int queueCapacity = 16; // waves, anything past this is dropped
+
+    GameManager* game;
+    Window* window;
+    Settings settings;
+
+    uint64_t nextWave[int(WaveKind::Count)] = {}; // tick each kind's next wave is due on
+    ScriptHandle waveScript; // one script for every kind, so same-tick waves go in kind order
+    Wave queue[queueCapacity];
+    int queueHead = 0, queueSize = 0;
+
+    // stats, not part of the saved state
+    uint64_t spawned = 0;
+    uint64_t throttledSteps = 0; // steps where something was waiting but the cap said no
+    uint64_t droppedWaves = 0;
+    uint64_t fallbackPlacements = 0;
+
+    ScriptTask runWaves();
+    void schedule(WaveKind kind, SimContext& context);
+    int release(Wave& wave, int count, Player* target, SimContext& context); // returns how many it used up, 0 = not now
+    Vector2D placeAround(Vector2D center, float minDistance, const SDL_Rect& area, SimContext& context);
+
+public:
+    SpawnDirector(GameManager* game, Window* window);
+
+    // once per step, liveEnemies = enemies in the world right now
+    // does nothing while the queue is empty, the waves themselves come from the wave script
+    void update(Player* target, int liveEnemies);
+
+    // (re)starts the wave script, after construction and after loadState()
+    void scheduleTimers();
+
+    Settings& getSettings() { return settings; }
+    int getPendingSpawns() const;
+
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+    void addToHash(StateHash& hash) const;
+
+    void report(std::ostream& out) const;
+};
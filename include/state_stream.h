@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "utils.h"
+
+// flat byte (de)serialization of world state, used by the rewind buffer and restarts
+// everything is memcpy'd field by field, so only trivially copyable types go in
+class StateWriter {
+private:
+    std::vector<uint8_t>& out; // appended to, capacity is reused between saves
+
+public:
+    explicit StateWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void writeBytes(const void* data, size_t size) {
+        size_t at = out.size();
+        out.resize(at + size);
+        std::memcpy(out.data() + at, data, size);
+    }
+
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "state has to be plain data");
+        writeBytes(&value, sizeof(T));
+    }
+
+    void write(const Vector2D& v) { write(v.x); write(v.y); }
+
+    size_t position() const { return out.size(); }
+    // for size prefixes that are only known once the payload is written
+    template <typename T>
+    void patch(size_t at, const T& value) { std::memcpy(out.data() + at, &value, sizeof(T)); }
+};
+
+class StateReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t offset = 0;
+    bool failed = false; // ran past the end, everything after that reads as zero
+
+public:
+    StateReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    void readBytes(void* dest, size_t bytes) {
+        if (failed || offset + bytes > size) {
+            failed = true;
+            std::memset(dest, 0, bytes);
+            return;
+        }
+        std::memcpy(dest, data + offset, bytes);
+        offset += bytes;
+    }
+
+    template <typename T>
+    void read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "state has to be plain data");
+        readBytes(&value, sizeof(T));
+    }
+
+    void read(Vector2D& v) { read(v.x); read(v.y); }
+
+    void skip(size_t bytes) {
+        if (failed || offset + bytes > size) { failed = true; return; }
+        offset += bytes;
+    }
+
+    bool ok() const { return !failed; }
+    size_t position() const { return offset; }
+};
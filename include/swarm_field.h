@@ -0,0 +1,70 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <vector>
+#include "utils.h"
+
+// steering for the triangle swarms, rebuilt by the game manager at the start of every step from where things
+// were then and only read while entities update (so from any thread)
+// one coarse grid over the window plus a margin holds two things:
+//  - a flow field, the direction from each cell's center to the player, so homing is a single cell lookup instead
+//    of everyone doing their own maths
+//  - the swarm (every triangle) bucketed per cell, counting sorted so a cell is one contiguous run, for the
+//    neighbour queries the separation needs. each query looks at 3x3 cells, so it's about O(1) per triangle
+//    instead of a pass over all of them
+// not saved, it's all derived from positions
+class SwarmField {
+public:
+    struct Settings {
+        bool enabled = true;            // off = straight at the target and no separation, like it used to be
+        float cellSize = 64.0f;
+        float margin = 600.0f;          // grid reach outside the window, past that homing is done directly
+        float separationRadius = 48.0f; // no bigger than cellSize, the query only looks at the neighbouring cells
+        float separationWeight = 0.8f;  // under 1 so a crowd still ends up going towards the player, just spread out
+        int maxNeighbours = 12;         // caps the work in a dense blob, more than this doesn't change much
+    };
+
+private:
+    Settings settings;
+
+    // grid, recomputed from the window bounds in begin()
+    float originX = 0.0f, originY = 0.0f;
+    int columns = 0, rows = 0;
+
+    bool hasTarget = false;
+    Vector2D target;
+    bool flowReady = false;
+    std::vector<Vector2D> flow; // per cell, unit direction towards the target
+    // only the cells around a member get filled in (O(swarm), not O(grid)), stamped with the build they're from
+    std::vector<uint32_t> flowStamp;
+    uint32_t buildStamp = 0;
+
+    std::vector<Vector2D> pending;      // add() order
+    std::vector<uint32_t> pendingCells;
+    std::vector<uint32_t> cellStart;    // cells + 1 entries, members of cell c are [cellStart[c], cellStart[c + 1])
+    std::vector<uint32_t> cursor;       // scratch for the scatter
+    std::vector<Vector2D> members;      // by cell
+
+    // -1 outside the grid
+    int cellOf(Vector2D position) const;
+
+public:
+    Settings& getSettings() { return settings; }
+    const Settings& getSettings() const { return settings; }
+
+    // once per step: begin(), then setTarget() and add() for whatever's alive, then build()
+    void begin(const SDL_Rect& bounds);
+    void setTarget(Vector2D position) { target = position; hasTarget = true; }
+    void add(Vector2D position);
+    void build();
+
+    // unit direction from position towards target. from the field when it was built for that target,
+    // straight there otherwise (off the grid, too close for the coarse cells to be right, field disabled)
+    Vector2D flowAt(Vector2D position, Vector2D target) const;
+    // push away from swarm members in separationRadius, already weighted, zero if nobody's close
+    // anything exactly at position is skipped, that includes whoever's asking
+    Vector2D separation(Vector2D position) const;
+
+    size_t getMemberCount() const { return members.size(); }
+};
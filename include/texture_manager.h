@@ -0,0 +1,35 @@
+#pragma once
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <map>
+#include <string>
+
+// textures loaded so far, keyed by path
+// one per window (textures belong to a renderer), so nothing here is shared between games
+class TextureManager {
+    public:
+        TextureManager() = default;
+        TextureManager(const TextureManager&) = delete;
+        TextureManager& operator=(const TextureManager&) = delete;
+        ~TextureManager() { cleanup(); }
+
+        SDL_Texture* getTexture(const std::string& path, SDL_Renderer* renderer);
+        void cleanup(); // before the renderer goes
+    private:
+        std::map<std::string, SDL_Texture*> textures;
+    };
+
+// every size renderText() has asked for, kept open (opening one means reading the font file)
+// only ever a handful of sizes, the hud and the pause text
+struct FontCache {
+    std::map<int, TTF_Font*> fonts;
+
+    FontCache() = default;
+    FontCache(const FontCache&) = delete;
+    FontCache& operator=(const FontCache&) = delete;
+    ~FontCache() { close(); }
+
+    TTF_Font* get(int size);
+    void close();
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// returned by schedule(), lets the owner cancel or check its timer
+// stays safe to use after the timer fired or the wheel was reset, it just stops matching anything
+struct TimerHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// hierarchical timing wheel over sim ticks
+// 4 levels of 64 slots: level 0 holds the next 64 ticks one slot per tick, level 1 the next 64*64 in
+// 64-tick slots and so on, anything past 2^24 ticks waits in an overflow list. a tick only looks at
+// one level 0 slot (plus a cascade every 64 ticks), so idle timers cost nothing however many there are
+//
+// events are plain data, whoever advances the wheel decides what a kind means
+// sim thread only, never touched from the parallel entity pass
+class TimingWheel {
+public:
+    struct Event {
+        uint64_t due;
+        void* target;
+        uint32_t data;
+        uint16_t kind;
+    };
+
+private:
+    static constexpr int slotBits = 6;
+    static constexpr int slotsPerLevel = 1 << slotBits;
+    static constexpr int levels = 4;
+    static constexpr uint32_t none = UINT32_MAX;
+    static constexpr int overflowList = levels * slotsPerLevel;
+    static constexpr int firingList = overflowList + 1;
+    static constexpr int listCount = firingList + 1;
+
+    struct Node {
+        Event event;
+        uint32_t prev, next;
+        uint32_t generation;
+        int32_t list; // which list it's linked into, -1 = free
+    };
+
+    std::vector<Node> nodes;
+    uint32_t freeHead = none;
+    uint32_t heads[listCount];
+    uint64_t now = 0; // last tick advanced to
+    size_t count = 0;
+
+    int listFor(uint64_t due) const;
+    void link(uint32_t index, int list);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(int list);
+
+public:
+    explicit TimingWheel(size_t reserve = 256);
+
+    // drops everything, the next advance() continues from tick
+    // handles from before the reset stop matching
+    void reset(uint64_t tick);
+
+    // fires on the first advance() that reaches dueTick, anything due now or earlier fires on the next one
+    TimerHandle schedule(uint64_t dueTick, uint16_t kind, void* target, uint32_t data = 0);
+    bool cancel(TimerHandle& handle); // false if it already fired or was cancelled
+    bool isPending(const TimerHandle& handle) const;
+
+    // fires everything due up to and including tick, in tick order
+    // events on the same tick come out in no particular order, don't make two of them depend on each other
+    // fire(const Event&) may schedule or cancel freely
+    template <typename Fn>
+    void advance(uint64_t tick, Fn&& fire) {
+        while (now < tick) {
+            now++;
+            // refill the lower levels when a higher one rolls over, top down
+            for (int level = levels - 1; level >= 1; level--) {
+                if ((now & ((uint64_t(1) << (slotBits * level)) - 1)) == 0) {
+                    if (level == levels - 1 && (now & ((uint64_t(1) << (slotBits * levels)) - 1)) == 0) {
+                        cascade(overflowList);
+                    }
+                    cascade(level * slotsPerLevel + int((now >> (slotBits * level)) & (slotsPerLevel - 1)));
+                }
+            }
+
+            // everything in this slot is due now, move it aside so callbacks can't disturb the walk
+            int slot = int(now & (slotsPerLevel - 1));
+            heads[firingList] = heads[slot];
+            heads[slot] = none;
+            for (uint32_t i = heads[firingList]; i != none; i = nodes[i].next) {
+                nodes[i].list = firingList;
+            }
+            while (heads[firingList] != none) {
+                uint32_t index = heads[firingList];
+                Event event = nodes[index].event; // fire() may grow nodes
+                unlink(index);
+                release(index);
+                fire(event);
+            }
+        }
+    }
+
+    size_t size() const { return count; }
+    uint64_t getTick() const { return now; }
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// lock-free triple buffer for one writer and one reader
+// the writer always has a private back buffer, the reader always has a private front buffer,
+// and the third one sits in the middle. publishing/consuming is a single atomic exchange,
+// so neither side ever waits on the other. the reader just sees the newest published value
+template <typename T>
+class TripleBuffer {
+private:
+    static constexpr uint8_t indexMask = 0x3;
+    static constexpr uint8_t freshBit = 0x4; // middle holds something the reader hasn't seen
+
+    T buffers[3];
+    std::atomic<uint8_t> middle{1};
+    uint8_t back = 0;  // writer only
+    uint8_t front = 2; // reader only
+
+public:
+    // writer side
+    T& writeBuffer() { return buffers[back]; }
+    void publish() {
+        uint8_t previous = middle.exchange(back | freshBit, std::memory_order_acq_rel);
+        back = previous & indexMask;
+    }
+
+    // reader side, returns true if a newer value was swapped in
+    bool update() {
+        if (!(middle.load(std::memory_order_acquire) & freshBit)) return false;
+        uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & indexMask;
+        return true;
+    }
+    const T& readBuffer() const { return buffers[front]; }
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// easing curves, sampled once into tables so nothing calls std::pow per use
+enum class Easing : uint8_t {
+    Linear,
+    OutQuad,
+    OutCubic,
+    OutQuart,
+    OutExpo,
+    Step, // from for the first half, to for the second (a blink, with TweenMode::Loop)
+    Count
+};
+
+// t in [0, 1], clamped. table lookup + lerp between neighbouring samples
+float ease(Easing easing, float t);
+
+enum class TweenMode : uint8_t {
+    Once,    // holds at to and goes away when done
+    Loop,    // from -> to, from -> to, ... until cancelled
+    PingPong // from -> to -> from ... until cancelled
+};
+
+// returned by Tweens::start(), same rules as TimerHandle: safe to keep around after the tween finished,
+// was cancelled or the tweens were reset, it just stops matching anything
+struct TweenHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// every running animation in the game, one float each, in parallel arrays
+// advance() goes over all of them in one pass per step and writes straight into the animated property,
+// so an entity that isn't animating isn't in here and costs nothing. a timeline is just tweens with staggered
+// start ticks, one that hasn't started yet doesn't write anything
+//
+// time is sim ticks, so a run animates the same way every time. same rules as the scripts:
+// sim thread only, serial code only, not saved. whoever owns a tween keeps its start tick in its own state
+// and starts it again from scheduleTimers() after a load, and cancels it in cancelTimers() (the target is a
+// raw pointer into the owner). one tween per property, cancel the old one before starting another
+class Tweens {
+private:
+    // dense, swap-removed, indexed the same across all of them
+    std::vector<float*> targets;
+    std::vector<float> from, span; // span = to - from
+    std::vector<uint64_t> startTick;
+    std::vector<float> inverseDuration; // 1 / ticks
+    std::vector<Easing> easings;
+    std::vector<TweenMode> modes;
+    std::vector<uint32_t> owners; // handle slot of each, to fix up the slot when something moves in the swap
+    std::vector<float> progress;  // scratch for advance()
+
+    // handle slot -> dense index, stable while the dense arrays move around
+    struct Slot {
+        uint32_t dense;
+        uint32_t generation = 0;
+    };
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    uint64_t now = 0;
+
+    void remove(uint32_t dense);
+
+public:
+    Tweens();
+
+    // starting on a tick that's already here writes from straight away, so whatever's drawn this step has it
+    TweenHandle start(float* target, float from, float to, uint64_t startTick, uint64_t durationTicks,
+                      Easing easing = Easing::Linear, TweenMode mode = TweenMode::Once);
+    bool cancel(TweenHandle& handle); // false if it was already done
+    bool isRunning(const TweenHandle& handle) const;
+
+    // every tween's value for tick, written to its target. finished ones write to one last time and go
+    void advance(uint64_t tick);
+    // drops everything (a load), handles from before stop matching
+    void reset(uint64_t tick);
+
+    uint64_t getTick() const { return now; }
+    size_t size() const { return targets.size(); }
+};
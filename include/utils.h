@@ -10,29 +10,30 @@
 #include <cmath>
 #include "window.h"
 #include "globals.h"
+#include "input_state.h"
 
 using namespace std;
  
 SDL_Texture* loadTexture(const std::string& path, SDL_Renderer* renderer);
 std::string fetchResourcePath(const std::string& filename);
+void preloadTextures(Window* window);
 
-// Simple text rendering utility
-void renderText(SDL_Renderer* renderer, const std::string& text, int x, int y, int fontSize = 16, SDL_Color color = {255, 255, 255, 255});
+// Simple text rendering utility, the font stays open in the window's font cache
+void renderText(Window* window, const char* text, int x, int y, int fontSize = 16, SDL_Color color = {255, 255, 255, 255});
+void renderText(Window* window, const std::string& text, int x, int y, int fontSize = 16, SDL_Color color = {255, 255, 255, 255});
 
 std::pair<int, int> getResolution();
 Window* init();
+Window* initHeadless(); // geometry-only window for running the sim without a display
 Window* createOverlayWindow();
 void destroy(Window* window);
 void cleanup(map<string, Window*> windows);
-void checkMovement(SDL_Event event, std::map<std::string, bool>& keyState);
-void checkMouseMovement(SDL_Event event, std::map<std::string, bool>& mouseState);
-void waitForFrame(int fps, Uint32 frameStart);
-map<string, bool> getKeyState();
-map<string, bool> getMouseState();
+void checkMovement(const SDL_Event& event, InputState& input);
+void checkMouseMovement(const SDL_Event& event, InputState& input);
 
 struct Vector2D {
     float x, y;
-    Vector2D(float x = 0, float y = 0) : x(x), y(y) {}
+    constexpr Vector2D(float x = 0, float y = 0) : x(x), y(y) {}
     Vector2D operator+(const Vector2D& other) const {return Vector2D(x + other.x, y + other.y);}
     Vector2D operator-(const Vector2D& other) const {return Vector2D(x - other.x, y - other.y);}
     Vector2D operator*(float a) const {return Vector2D(x * a, y * a);}
@@ -41,7 +42,7 @@ struct Vector2D {
     Vector2D& operator/=(float a) {x /= a; y /= a; return *this;}
     Vector2D& operator+=(const Vector2D& other) {x += other.x; y += other.y; return *this;}
     Vector2D& operator-=(const Vector2D& other) {x -= other.x; y -= other.y; return *this;}
-    Vector2D& operator=(const Vector2D& other) {
+    constexpr Vector2D& operator=(const Vector2D& other) {
         if (this == &other) return *this;
         x = other.x;
         y = other.y;
@@ -64,11 +65,3 @@ struct Point2D {
     Point2D(float x = 0, float y = 0) : x(x), y(y) {}
 };
 // i think i've used this like.... once
-
-class TextureManager {
-    public:
-        static SDL_Texture* getTexture(const std::string& path, SDL_Renderer* renderer);
-        static void cleanup();
-    private:
-        static std::map<std::string, SDL_Texture*> textures;
-    };
\ No newline at end of file
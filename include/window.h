@@ -3,9 +3,13 @@
 #include <SDL.h>
 #include <string>
 #include <vector>
+#include "texture_manager.h"
 
 using namespace std;
 
+class StateWriter;
+class StateReader;
+
 struct ResizeRequest {
     int topTarget, bottomTarget, leftTarget, rightTarget;
     bool active;
@@ -34,15 +38,12 @@ struct ResizeRequest {
 class Window {
 private:
     vector<ResizeRequest> resizeRequests;
+    float stepAccumulator = 0.0f; // see update()
+    float clock = 0.0f; // seconds of simulated window time, resize animations run off this instead of SDL_GetTicks
+    SDL_Rect osRect; // geometry last pushed to the real window (main thread only)
     
     void applyResize(int top, int bottom, int left, int right);
 
-    // bunch of predefined easing functions
-    float easeOutCubic(float progress);
-    float easeOutQuart(float progress);
-    float easeOutExpo(float progress);
-    float easeOutQuad(float progress);
-
     void clampTargets(ResizeRequest& req);
     void applyImmediateResize(ResizeRequest& req);
     bool applyAnimatedResize(ResizeRequest& req, float deltaTime);
@@ -64,6 +65,9 @@ public:
     CollisionEdge collisionEdge;
     SDL_Renderer* renderer;
     int screenWidth, screenHeight;
+    bool headless = false; // geometry only, window and renderer stay null
+    TextureManager textures; // for this renderer, empty when headless
+    FontCache fonts;
     bool screenEdges[4] = {false, false, false, false}; // top bot left right
     const int MIN_SIZE = 150;
 
@@ -71,23 +75,34 @@ public:
     Window(int x, int y, int width, int height, float shrinkSpeed, std::string title, 
            bool isOnTop = false, bool isBorderless = false, bool isTransparent = false);
 
+    // headless: no os window, no renderer, the sim only ever needs the geometry
+    Window(int x, int y, int width, int height, float shrinkSpeed);
+
     // Destructor
     ~Window();
 
     // Window management methods
+    // setPos/setSize only change the simulated geometry, the os window catches up in syncToOS
+    // (SDL window calls have to stay on the main thread)
     void setTitle(const std::string& newTitle);
     void setPos(int x, int y);
     void setSize(int width, int height);
+    void syncToOS(const SDL_Rect& bounds);
 
     void createResizeRequest(int top, int bottom, int left, int right, int initialSpeed, float duration);
     void applyResizeRequest(ResizeRequest& request, float deltaTime);
     void clearResizeRequests() { resizeRequests.clear(); }
 
     void update(float deltaTime);
+    void step(float deltaTime);
     void naturalShrinking(const float &deltaTime);
     SDL_Rect getBounds();
     
     // Helper to get current dimensions
     void getDimensions(int& x, int& y, int& width, int& height);
     void checkScreenEdgesCollision();
+
+    // geometry + pending resizes, for rewind / restart
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
 };
@@ -1,15 +1,149 @@
 #include <SDL.h>
 #include <SDL_image.h>
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <memory>
+#include <cstring>
+#include <cstdlib>
 #include "include/globals.h"
 #include "include/utils.h"
 #include "include/window.h"
 #include "include/player.h"
 #include "include/game_manager.h"
+#include "include/frame_arena.h"
+#include "include/alloc_tracker.h"
+#include "include/simulation_thread.h"
+#include "include/render_snapshot.h"
+#include "include/headless.h"
+#include "include/frame_pacer.h"
+#include "include/input_recording.h"
+#include "include/job_system.h"
+#include "include/quality_governor.h"
 
 int main(int argc, char* argv[]) {
+    // --alloc-report              print allocation stats on exit (needs -DALLOC_TRACKING)
+    // --alloc-budget N            test mode: run a fixed number of frames, fail if the steady state frame allocates more than N times
+    // --alloc-frames N            frames to run in test mode (default 600)
+    // --seed N                    deterministic mode: all gameplay randomness comes from this seed
+    // --hash-log FILE             with --seed, write the world state hash of every sim tick to FILE
+    // --headless                  no window or renderer, run the simulation flat out and print timings
+    // --ticks N                   sim ticks to run headless (default 36000)
+    // --fps N                     render rate to pace to (default screenFPS)
+    // --vsync                     let present() pace the loop instead
+    // --uncapped                  don't pace at all
+    // --pacer-report              print frame time / overshoot stats on exit
+    // --rewind SECONDS            keep the last SECONDS of play, backspace while paused rewinds one second
+    // --rewind-budget MB          memory cap for the rewind history (default 64)
+    // --record FILE               record all input (plus seed) to FILE, implies a fixed seed
+    // --replay FILE               play FILE back instead of live input, with --headless as fast as possible
+    //                             (with the rewind history the recording had, --rewind doesn't matter then)
+    // --workers N                 threads for entity updates (default one per spare core, 0 = sim thread only)
+    // --no-lod                    update off-window enemies at full rate too
+    // --batch N                   with --headless: N independent sessions (seeds --seed, +1, ...) over the worker threads
+    // --batch-sync N              steps each batch world takes between lockstep points (default 1)
+    // --autopilot INTENSITY       the game plays itself, for soak tests (0 = casual, 1 = flat out, also scales spawning)
+    //                             spawn settings aren't in recordings, replay those with the same --autopilot
+    // --quality-budget MS         frame work the quality governor holds to (default one frame at --fps, 0 = off)
+    //                             headless: per sim step, and off unless given
+    bool allocReport = false;
+    int allocTestFrames = 0;
+    bool seeded = false;
+    uint64_t seed = 0;
+    const char* hashLogPath = nullptr;
+    bool headless = false;
+    HeadlessOptions headlessOptions;
+    FramePacer::Mode pacerMode = FramePacer::Mode::Capped;
+    bool pacerReport = false;
+    float rewindSeconds = 0.0f;
+    size_t rewindBudget = 64 * 1024 * 1024;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    int workers = -1;
+    bool simLod = true;
+    float autopilot = -1.0f;
+    float qualityBudgetMs = -1.0f; // < 0: default
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--alloc-report") == 0) {
+            allocReport = true;
+        } else if (std::strcmp(argv[i], "--alloc-budget") == 0 && i + 1 < argc) {
+            // without the counting it would pass every time, that's not a test
+            if (!allocTrackingEnabled) {
+                std::cerr << "--alloc-budget needs a build with -DALLOC_TRACKING" << std::endl;
+                return 1;
+            }
+            AllocTracker::setBudget(std::strtoull(argv[++i], nullptr, 10));
+            allocReport = true;
+            if (allocTestFrames == 0) allocTestFrames = 600;
+        } else if (std::strcmp(argv[i], "--alloc-frames") == 0 && i + 1 < argc) {
+            allocTestFrames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+            seeded = true;
+        } else if (std::strcmp(argv[i], "--hash-log") == 0 && i + 1 < argc) {
+            hashLogPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            headlessOptions.ticks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            screenFPS = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--vsync") == 0) {
+            pacerMode = FramePacer::Mode::VSync;
+        } else if (std::strcmp(argv[i], "--uncapped") == 0) {
+            pacerMode = FramePacer::Mode::Uncapped;
+        } else if (std::strcmp(argv[i], "--pacer-report") == 0) {
+            pacerReport = true;
+        } else if (std::strcmp(argv[i], "--rewind") == 0 && i + 1 < argc) {
+            rewindSeconds = float(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--rewind-budget") == 0 && i + 1 < argc) {
+            rewindBudget = size_t(std::atof(argv[++i]) * 1024 * 1024);
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-lod") == 0) {
+            simLod = false;
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            headlessOptions.batchWorlds = size_t(std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--batch-sync") == 0 && i + 1 < argc) {
+            headlessOptions.batchSync = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--autopilot") == 0 && i + 1 < argc) {
+            autopilot = float(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--quality-budget") == 0 && i + 1 < argc) {
+            qualityBudgetMs = float(std::atof(argv[++i]));
+        }
+    }
+
+    if (headless) {
+        headlessOptions.seeded = seeded;
+        headlessOptions.seed = seed;
+        headlessOptions.hashLogPath = hashLogPath;
+        headlessOptions.rewindSeconds = rewindSeconds;
+        headlessOptions.rewindBudget = rewindBudget;
+        headlessOptions.replayPath = replayPath;
+        headlessOptions.workers = workers;
+        headlessOptions.simLod = simLod;
+        headlessOptions.autopilot = autopilot;
+        headlessOptions.qualityBudget = std::max(qualityBudgetMs, 0.0f) / 1000.0f;
+        int exitCode = runHeadless(headlessOptions);
+        if (allocReport) {
+            AllocTracker::report(std::cerr);
+            if (!AllocTracker::withinBudget()) {
+                std::cerr << "Allocation budget exceeded" << std::endl;
+                exitCode = 1;
+            }
+        }
+        return exitCode;
+    }
+
+    // has to be set before the renderer is created
+    if (pacerMode == FramePacer::Mode::VSync) {
+        SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
+    }
+
     // initialize SDL + windows
     Window* mainWindow = init();
     if (!mainWindow) return -1;
@@ -21,110 +155,180 @@ int main(int argc, char* argv[]) {
     // the downside is that it blocks everything, but i guess that could be a safeguard for potential misclick
     Window* overlay = createOverlayWindow();
     
+    std::unique_ptr<InputReplay> replay;
+    if (replayPath) {
+        replay = std::make_unique<InputReplay>();
+        if (!replay->open(replayPath)) return -1;
+        seeded = true;
+        seed = replay->getHeader().seed;
+
+        auto [w, h] = getResolution();
+        if (w != replay->getHeader().displayWidth || h != replay->getHeader().displayHeight) {
+            std::cerr << "Recording was made on a " << replay->getHeader().displayWidth << "x" << replay->getHeader().displayHeight
+                      << " display, this one is " << w << "x" << h << ", it won't replay the same (try --headless)" << std::endl;
+        }
+    }
+
+    JobSystem jobs(workers < 0 ? JobSystem::defaultWorkerCount() : unsigned(workers));
     GameManager gameManager(mainWindow);
+    gameManager.setJobSystem(&jobs);
+    gameManager.getLodSettings().enabled = simLod;
+    if (recordPath && !seeded) {
+        // restarts have to reuse the seed too, or the recording can't be replayed
+        seed = gameManager.getContext().seed;
+        seeded = true;
+    }
+    if (seeded) {
+        gameManager.setSeed(seed);
+        std::cerr << "Deterministic mode, seed " << seed << std::endl;
+    }
 
     // create & register Player
-    SDL_Rect bounds = mainWindow->getBounds();
-    int startX = bounds.x + bounds.w/2;
-    int startY = bounds.y + bounds.h/2;
-    float playerSpeed = 500.0f;
-    int   playerRadius = 25;
-    
-    // allocate Player on the heap and hand to manager
-    auto player = std::make_unique<Player>(
-        Vector2D(startX, startY),
-        playerRadius,
-        playerSpeed,
-        mainWindow
-    );
-    Player* playerPtr = player.get();
-    playerPtr->setGameManager(&gameManager);
-    gameManager.addObject(std::move(player)); 
+    Player* playerPtr = gameManager.createPlayer();
+    gameManager.captureInitialState(); // restarts load this
+
+    // textures have to be loaded here, entities are created on the simulation thread
+    preloadTextures(mainWindow);
+
+    // from here on the game state belongs to the simulation thread
+    SimulationThread simulation(gameManager, mainWindow, playerPtr);
+    if (hashLogPath) {
+        simulation.setHashLog(hashLogPath);
+    }
+    if (rewindSeconds > 0.0f) {
+        simulation.enableRewind(rewindSeconds, rewindBudget);
+    }
+    if (recordPath) {
+        simulation.startRecording(recordPath);
+    }
+    if (replay) {
+        simulation.startReplay(std::move(replay));
+    }
+    if (autopilot >= 0.0f) {
+        simulation.enableAutopilot(autopilot);
+    }
+    if (qualityBudgetMs != 0.0f) {
+        QualityGovernor::Settings quality;
+        quality.budget = qualityBudgetMs > 0.0f ? qualityBudgetMs / 1000.0f : 1.0f / std::max(screenFPS, 1);
+        simulation.enableQualityGovernor(quality);
+    }
+    simulation.start();
 
     bool quit = false;
     SDL_Event event;
-    Uint32 lastTick = SDL_GetTicks();
-    auto [screenW, screenH] = getResolution();
+    FramePacer pacer(screenFPS, pacerMode);
+    pacer.start();
+
+    // paused / game over: the paused frame is drawn once and the loop sleeps on events instead of pacing
+    PausedFrame pausedFrame;
+    bool idle = false;
     
     while (!quit) {
-        // ——— frame timing ———
-        Uint32 now = SDL_GetTicks();
-        float  dt = (now - lastTick) / 1000.0f;
-        lastTick = now;
+        // everything allocated from the arena last frame is dead now
+        frameArena().reset();
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+        Uint64 presentTime = 0;
+        bool exposed = false; // the os wants the window repainted
 
         // ——— handle input ———
-        while (SDL_PollEvent(&event)) {
+        // sdl events have to be polled here, everything but quitting is forwarded to the sim thread
+        auto handleEvent = [&](const SDL_Event& event) {
             if (event.type == SDL_QUIT) {
                 quit = true;
-            
-            // pause/resume
-            } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) {
-                if (gameManager.getGameState() == GameState::RUNNING) {
-                    gameManager.pauseGame();
-                } else if (gameManager.getGameState() == GameState::PAUSED) {
-                    gameManager.resumeGame();
-                }
-            // restart
-            } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_r) {
-                if (gameManager.getGameState() == GameState::PAUSED || 
-                    gameManager.getGameState() == GameState::GAME_OVER) {
-                    gameManager.restartGame();
-                    
-                    // Find the active player after restart
-                    playerPtr = nullptr;
-                    for (auto& obj : gameManager.getGameObjects()) {
-                        if (obj->getType() == GameObject::ObjectType::Player) {
-                            playerPtr = static_cast<Player*>(obj.get());
-                            break;
-                        }
-                    }
-                }
             // ragequit
             } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_p) {
                 quit = true;
+            } else if (event.type == SimulationThread::snapshotEvent) {
+                // only there to wake us up, the snapshot is picked up below
+            } else if (event.type == SDL_RENDER_TARGETS_RESET) {
+                // the cached paused frame lost its pixels, draw it again
+                pausedFrame.invalidate();
+                exposed = true;
+            } else if (event.type == SDL_RENDER_DEVICE_RESET) {
+                pausedFrame.release(); // the texture itself is gone, update() makes a new one
+                exposed = true;
             } else {
-                checkMovement(event, keyState);
-                
-                // Only process player input if game is running and player pointer is valid
-                if (gameManager.getGameState() == GameState::RUNNING && playerPtr && playerPtr->getActive()) {
-                    gameManager.handleInput(event, playerPtr);
-                }
+                if (event.type == SDL_WINDOWEVENT) exposed = true;
+                simulation.pushEvent(event);
             }
+        };
+        // idle: nothing changes until there's input, a repaint request, or the sim publishes (it pushes
+        // a snapshotEvent for that while paused), the timeout is only a safety net
+        if (idle && SDL_WaitEventTimeout(&event, 250)) {
+            handleEvent(event);
         }
-        
-        // ——— update & collision ———
-        if (!gameManager.isPaused()) {
-            mainWindow->update(dt);
+        while (SDL_PollEvent(&event)) {
+            handleEvent(event);
         }
-        gameManager.update(dt);
         
         // ——— render ———
-        SDL_SetRenderDrawColor(mainWindow->renderer, 0, 0, 0, 255);
-        SDL_RenderClear(mainWindow->renderer);
-        
-        // Draw game objects
-        gameManager.draw(mainWindow->renderer);
-        
-        if (gameManager.isPaused()) {
-            // draw an overlay to indicate pause (and maybe some text)
-            SDL_SetRenderDrawBlendMode(mainWindow->renderer, SDL_BLENDMODE_BLEND);
-            SDL_SetRenderDrawColor(mainWindow->renderer, 0, 0, 0, 128);
-            SDL_Rect fullscreen = {0, 0, mainWindow->width, mainWindow->height};
-            SDL_RenderFillRect(mainWindow->renderer, &fullscreen);
-            
-            SDL_Color pausedTextColor = {255, 255, 255, 255};
-            int fontSize = 12;
-            renderText(mainWindow->renderer, "PAUSED", 20, 20, fontSize, pausedTextColor);
-            renderText(mainWindow->renderer, "Press R to restart", 20, 40, fontSize, pausedTextColor);
-            renderText(mainWindow->renderer, "Press P to ragequit", 20, 60, fontSize, pausedTextColor);
+        ALLOC_SCOPE("render");
+        if (simulation.acquireSnapshot()) {
+            const RenderSnapshot& snapshot = simulation.getSnapshot();
+
+            // the sim only moves the window on paper, the real one follows here
+            mainWindow->syncToOS(snapshot.windowBounds);
+
+            if (snapshot.gameState == GameState::PAUSED || snapshot.gameState == GameState::GAME_OVER) {
+                if (pausedFrame.update(mainWindow, snapshot) || exposed || !idle) {
+                    pausedFrame.present(mainWindow, snapshot);
+                }
+                idle = true;
+            } else {
+                if (idle) {
+                    idle = false;
+                    pacer.start(); // or it would try to catch up on the whole pause
+                }
+
+                SDL_SetRenderDrawColor(mainWindow->renderer, 0, 0, 0, 255);
+                SDL_RenderClear(mainWindow->renderer);
+                
+                // Draw game objects
+                drawSnapshot(mainWindow, snapshot, snapshotAlpha(snapshot));
+                
+                Uint64 presentStart = SDL_GetPerformanceCounter();
+                SDL_RenderPresent(mainWindow->renderer);
+                // with vsync present is mostly waiting on the display, that's not work
+                if (pacerMode == FramePacer::Mode::VSync) {
+                    presentTime = SDL_GetPerformanceCounter() - presentStart;
+                }
+            }
         }
-        
-        SDL_RenderPresent(mainWindow->renderer);
 
-        // ——— cap to ~60 FPS ———
-        waitForFrame(screenFPS, lastTick);
+        AllocTracker::endFrame();
+        if (allocTestFrames > 0 && AllocTracker::framesRecorded() >= allocTestFrames) {
+            quit = true;
+        }
+
+        // ——— cap to screenFPS ———
+        if (!idle) {
+            simulation.reportFrameWork(float(double(SDL_GetPerformanceCounter() - frameStart - presentTime) / SDL_GetPerformanceFrequency()));
+            pacer.waitForNextFrame();
+        }
+    }
+
+    simulation.stop();
+
+    if (pacerReport) {
+        pacer.report(std::cerr);
+    }
+    if (simulation.getRewind()) {
+        simulation.getRewind()->report(std::cerr);
+    }
+    if (simulation.getGovernor()) {
+        simulation.getGovernor()->report(std::cerr);
+    }
+
+    int exitCode = 0;
+    if (allocReport) {
+        AllocTracker::report(std::cerr);
+        if (!AllocTracker::withinBudget()) {
+            std::cerr << "Allocation budget exceeded" << std::endl;
+            exitCode = 1;
+        }
     }
 
+    pausedFrame.release();
     cleanup({{"main",mainWindow},{"overlay",overlay}});
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "../include/alloc_tracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+// everything below is plain arrays and atomics, the tracker can't allocate from inside operator new
+
+namespace {
+
+struct ScopeCounters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+const char* scopeNames[AllocTracker::maxScopes] = {"untracked"};
+// only grows, under scopeMutex. published after the name is in, so a reader that sees the count
+// without the lock (endFrame, report) sees every name below it too
+std::atomic<int> scopeCount{1};
+std::mutex scopeMutex;
+
+ScopeCounters frameCounters[AllocTracker::maxScopes];
+std::atomic<uint64_t> frameFrees{0};
+
+// main thread only, updated in endFrame
+uint64_t totalAllocations[AllocTracker::maxScopes];
+uint64_t totalBytes[AllocTracker::maxScopes];
+uint64_t peakScopeAllocations[AllocTracker::maxScopes];
+
+uint64_t history[AllocTracker::historySize];
+int historyHead = 0;
+int frameCount = 0;
+uint64_t peakFrameAllocations = 0;
+AllocTracker::FrameStats previousFrame;
+
+thread_local int currentScope = AllocTracker::untrackedScope;
+
+} // namespace
+
+int AllocTracker::warmupFrames = 120;
+uint64_t AllocTracker::budget = 0;
+bool AllocTracker::budgetSet = false;
+
+int AllocTracker::registerScope(const char* name) {
+    std::lock_guard<std::mutex> lock(scopeMutex);
+    int count = scopeCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++) {
+        if (std::strcmp(scopeNames[i], name) == 0) return i;
+    }
+    if (count >= maxScopes) return untrackedScope; // out of slots, lump it in with the rest
+    scopeNames[count] = name;
+    scopeCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+int AllocTracker::enterScope(int id) {
+    int previous = currentScope;
+    currentScope = id;
+    return previous;
+}
+
+void AllocTracker::exitScope(int previous) {
+    currentScope = previous;
+}
+
+void AllocTracker::recordAllocation(size_t bytes) {
+    ScopeCounters& counters = frameCounters[currentScope];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AllocTracker::recordFree() {
+    frameFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocTracker::endFrame() {
+    FrameStats frame;
+    int scopes = scopeCount.load(std::memory_order_acquire);
+    for (int i = 0; i < scopes; i++) {
+        uint64_t allocations = frameCounters[i].allocations.exchange(0, std::memory_order_relaxed);
+        uint64_t bytes = frameCounters[i].bytes.exchange(0, std::memory_order_relaxed);
+        frame.allocations += allocations;
+        frame.bytes += bytes;
+
+        totalAllocations[i] += allocations;
+        totalBytes[i] += bytes;
+        if (frameCount >= warmupFrames) {
+            peakScopeAllocations[i] = std::max(peakScopeAllocations[i], allocations);
+        }
+    }
+    frame.frees = frameFrees.exchange(0, std::memory_order_relaxed);
+    previousFrame = frame;
+
+    if (frameCount >= warmupFrames) {
+        history[historyHead] = frame.allocations;
+        historyHead = (historyHead + 1) % historySize;
+        peakFrameAllocations = std::max(peakFrameAllocations, frame.allocations);
+    }
+    frameCount++;
+}
+
+AllocTracker::FrameStats AllocTracker::lastFrame() {
+    return previousFrame;
+}
+
+int AllocTracker::framesRecorded() {
+    return std::max(0, frameCount - warmupFrames);
+}
+
+uint64_t AllocTracker::steadyStateAllocations() {
+    int samples = std::min(framesRecorded(), historySize);
+    if (samples == 0) return 0;
+
+    uint64_t sorted[historySize];
+    std::copy(history, history + samples, sorted);
+    std::nth_element(sorted, sorted + samples / 2, sorted + samples);
+    return sorted[samples / 2];
+}
+
+uint64_t AllocTracker::peakAllocations() {
+    return peakFrameAllocations;
+}
+
+bool AllocTracker::withinBudget() {
+    if (!budgetSet) return true;
+    return steadyStateAllocations() <= budget;
+}
+
+void AllocTracker::report(std::ostream& out) {
+    if (!allocTrackingEnabled) {
+        out << "allocation tracking is compiled out (build with -DALLOC_TRACKING)\n";
+        return;
+    }
+
+    int frames = std::max(1, frameCount);
+    out << "--- allocations over " << frameCount << " frames (" << warmupFrames << " warmup) ---\n";
+    out << "steady state: " << steadyStateAllocations() << " allocs/frame, peak: " << peakAllocations() << " allocs/frame\n";
+    int scopes = scopeCount.load(std::memory_order_acquire);
+    for (int i = 0; i < scopes; i++) {
+        if (totalAllocations[i] == 0) continue;
+        out << "  " << scopeNames[i]
+            << ": " << double(totalAllocations[i]) / frames << " allocs/frame, "
+            << double(totalBytes[i]) / frames << " bytes/frame, peak "
+            << peakScopeAllocations[i] << " allocs\n";
+    }
+    if (budgetSet) {
+        out << "budget: " << budget << " allocs/frame -> " << (withinBudget() ? "ok" : "EXCEEDED") << "\n";
+    }
+}
+
+#ifdef ALLOC_TRACKING
+
+// global replacements, the aligned overloads are left to the default implementation
+
+void* operator new(size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    AllocTracker::recordAllocation(size);
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    void* p = std::malloc(size ? size : 1);
+    if (p) AllocTracker::recordAllocation(size);
+    return p;
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    AllocTracker::recordFree();
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    operator delete(p);
+}
+
+#endif // ALLOC_TRACKING
@@ -0,0 +1,216 @@
+#include "../include/autopilot.h"
+#include "../include/game_manager.h"
+#include "../include/player.h"
+#include "../include/entities.h"
+#include "../include/window.h"
+#include "../include/frame_arena.h"
+#include <algorithm>
+#include <cmath>
+
+Autopilot::Autopilot(float intensity, uint64_t seed) :
+    random(seed, 0xa7) // any stream, only has to be its own
+{
+    settings.intensity = std::max(0.0f, intensity);
+    settings.shotsPerSecond = 4.0f + 26.0f * settings.intensity;
+    settings.edgeShotShare = std::min(0.4f + 0.3f * settings.intensity, 0.8f);
+    pending.reserve(16);
+}
+
+void Autopilot::applyPressure(SpawnDirector::Settings& spawns) const {
+    float scale = 1.0f + 3.0f * settings.intensity;
+    for (float& interval : spawns.intervals) {
+        interval /= scale;
+    }
+    spawns.liveCap = int(spawns.liveCap * scale);
+    spawns.spawnsPerStep = int(std::ceil(spawns.spawnsPerStep * scale));
+}
+
+void Autopilot::deliver(GameManager& game, const SDL_Event& event) {
+    checkMovement(event, game.getContext().input);
+    Player* player = game.findPlayer();
+    if (game.getGameState() == GameState::RUNNING && player && player->getActive()) {
+        game.handleInput(event, player);
+    }
+}
+
+void Autopilot::think(GameManager& game) {
+    pending.clear();
+    const InputState& held = game.getContext().input;
+
+    // nobody is going to press R
+    if (game.getGameState() == GameState::GAME_OVER) {
+        SDL_Event event{};
+        event.type = SDL_KEYDOWN;
+        event.key.state = SDL_PRESSED;
+        event.key.keysym.sym = SDLK_r;
+        pending.push_back(event);
+        event.type = SDL_KEYUP;
+        event.key.state = SDL_RELEASED;
+        pending.push_back(event);
+        return;
+    }
+
+    Player* player = game.findPlayer();
+    if (game.getGameState() != GameState::RUNNING || !player || !player->getActive() || player->isInDeathAnimation()) {
+        pressKeys(held, Vector2D(0, 0)); // let go of everything
+        shotCredit = 0.0f;
+        return;
+    }
+
+    SDL_Rect bounds = game.getWindow()->getBounds();
+    pressKeys(held, steer(game, *player, bounds));
+
+    shotCredit += settings.shotsPerSecond * game.getClock().deltaTime;
+    if (shotCredit < 1.0f) return;
+
+    Vector2D pos = player->getPosition();
+    Vector2D target;
+    bool haveTarget = findCluster(game, target); // once per step, every shot this step goes there
+    for (; shotCredit >= 1.0f; shotCredit -= 1.0f) {
+        if (haveTarget && random.unit() >= settings.edgeShotShare) {
+            click(target);
+            continue;
+        }
+        // straight at an edge, the window grows there and the resize animation kicks in
+        switch (random.bounded(4)) {
+            case 0: click(Vector2D(pos.x, float(bounds.y) - 50.0f)); break;
+            case 1: click(Vector2D(pos.x, float(bounds.y + bounds.h) + 50.0f)); break;
+            case 2: click(Vector2D(float(bounds.x) - 50.0f, pos.y)); break;
+            case 3: click(Vector2D(float(bounds.x + bounds.w) + 50.0f, pos.y)); break;
+        }
+    }
+}
+
+Vector2D Autopilot::steer(GameManager& game, const Player& player, const SDL_Rect& bounds) const {
+    Vector2D pos = player.getPosition();
+    float radius = player.getDimensions().x / 2.0f;
+    Vector2D want(0, 0);
+
+    for (const auto& object : game.getGameObjects()) {
+        if (!object->isAlive()) continue;
+
+        switch (object->getType()) {
+            case GameObject::ObjectType::Beam: {
+                // a beam only ever sweeps one lane, get out of it sideways
+                const Beam& beam = static_cast<const Beam&>(*object);
+                if (beam.getState() == Beam::BeamState::FADING) break;
+                bool vertical = beam.isVertical();
+                Vector2D beamPos = beam.getPosition();
+                float center = vertical ? beamPos.x : beamPos.y;
+                float width = std::max(vertical ? beam.getDimensions().x : beam.getDimensions().y, beam.getBeamWidth());
+                float clearance = width / 2.0f + radius + settings.beamMargin;
+                float along = vertical ? pos.x : pos.y;
+                if (std::abs(along - center) >= clearance) break;
+
+                // the nearer side, unless the window edge is in the way there
+                float low = vertical ? float(bounds.x) + radius : float(bounds.y) + radius;
+                float high = vertical ? float(bounds.x + bounds.w) - radius : float(bounds.y + bounds.h) - radius;
+                float side = along < center ? -1.0f : 1.0f;
+                float exit = center + side * clearance;
+                if (exit < low || exit > high) side = -side;
+
+                // warning ones still leave time, anything further along wins over everything else
+                float push = beam.getState() == Beam::BeamState::WARNING ? 3.0f : 6.0f;
+                if (vertical) want.x += side * push;
+                else want.y += side * push;
+                break;
+            }
+            case GameObject::ObjectType::Triangle:
+            case GameObject::ObjectType::Pentagon: {
+                // kiting: back off from whatever is close, harder the closer it is
+                float reach = settings.kiteRadius;
+                if (object->getType() == GameObject::ObjectType::Pentagon) reach *= 1.4f;
+                Vector2D away = pos - object->getPosition();
+                float distanceSquared = away.lengthSquared();
+                if (distanceSquared >= reach * reach || distanceSquared == 0.0f) break;
+                float distance = std::sqrt(distanceSquared);
+                want += away * ((1.0f - distance / reach) / distance);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // and towards the middle, so backing off doesn't end with it pinned in a corner
+    Vector2D center(bounds.x + bounds.w / 2.0f, bounds.y + bounds.h / 2.0f);
+    want.x += (center.x - pos.x) / std::max(bounds.w / 2.0f, 1.0f);
+    want.y += (center.y - pos.y) / std::max(bounds.h / 2.0f, 1.0f);
+    return want;
+}
+
+bool Autopilot::findCluster(GameManager& game, Vector2D& aim) const {
+    FrameVector<Vector2D> enemies;
+    for (const auto& object : game.getGameObjects()) {
+        GameObject::ObjectType type = object->getType();
+        if (object->isAlive() && (type == GameObject::ObjectType::Triangle || type == GameObject::ObjectType::Pentagon)) {
+            enemies.push_back(object->getPosition());
+        }
+    }
+    if (enemies.empty()) return false;
+
+    // most neighbours within clusterRadius wins, only a spread out sample of candidates gets counted
+    // so a full screen stays cheap (candidates * enemies)
+    constexpr size_t maxCandidates = 64;
+    size_t stride = std::max<size_t>(1, enemies.size() / maxCandidates);
+    float radiusSquared = settings.clusterRadius * settings.clusterRadius;
+    size_t best = 0;
+    int bestCount = -1;
+    for (size_t i = 0; i < enemies.size(); i += stride) {
+        int count = 0;
+        for (const Vector2D& other : enemies) {
+            if ((other - enemies[i]).lengthSquared() <= radiusSquared) count++;
+        }
+        if (count > bestCount) {
+            bestCount = count;
+            best = i;
+        }
+    }
+
+    Vector2D sum(0, 0);
+    for (const Vector2D& other : enemies) {
+        if ((other - enemies[best]).lengthSquared() <= radiusSquared) sum += other;
+    }
+    aim = sum / float(bestCount);
+    return true;
+}
+
+void Autopilot::pressKeys(const InputState& held, Vector2D want) {
+    bool up = false, down = false, left = false, right = false;
+    float length = want.magnitude();
+    if (length > 0.15f) { // otherwise stand still, it's close enough to balanced
+        Vector2D direction = want / length;
+        // 8 directions, a component has to be past ~22 degrees to count
+        up = direction.y < -0.38f;
+        down = direction.y > 0.38f;
+        left = direction.x < -0.38f;
+        right = direction.x > 0.38f;
+    }
+
+    auto key = [this](bool now, bool was, SDL_Keycode code) {
+        if (now == was) return;
+        SDL_Event event{};
+        event.type = now ? SDL_KEYDOWN : SDL_KEYUP;
+        event.key.state = now ? SDL_PRESSED : SDL_RELEASED;
+        event.key.keysym.sym = code;
+        pending.push_back(event);
+    };
+    key(up, held.up, SDLK_UP);
+    key(down, held.down, SDLK_DOWN);
+    key(left, held.left, SDLK_LEFT);
+    key(right, held.right, SDLK_RIGHT);
+}
+
+void Autopilot::click(Vector2D at) {
+    SDL_Event event{};
+    event.type = SDL_MOUSEBUTTONDOWN;
+    event.button.button = SDL_BUTTON_LEFT;
+    event.button.state = SDL_PRESSED;
+    event.button.clicks = 1;
+    event.button.x = Sint32(std::lround(at.x));
+    event.button.y = Sint32(std::lround(at.y));
+    pending.push_back(event);
+    event.type = SDL_MOUSEBUTTONUP;
+    event.button.state = SDL_RELEASED;
+    pending.push_back(event);
+}
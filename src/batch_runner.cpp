@@ -0,0 +1,123 @@
+#include "../include/batch_runner.h"
+#include "../include/game_manager.h"
+#include "../include/player.h"
+#include "../include/window.h"
+#include "../include/utils.h"
+#include "../include/globals.h"
+#include "../include/frame_arena.h"
+#include "../include/job_system.h"
+#include "../include/sim_context.h"
+#include <algorithm>
+#include <numeric>
+
+void BatchResults::resize(size_t worlds) {
+    seeds.assign(worlds, 0);
+    ticks.assign(worlds, 0);
+    scores.assign(worlds, 0);
+    died.assign(worlds, 0);
+    peakObjects.assign(worlds, 0);
+    stateHashes.assign(worlds, 0);
+}
+
+uint64_t BatchResults::combinedHash() const {
+    StateHash hash;
+    for (uint64_t value : stateHashes) {
+        hash.add(value);
+    }
+    return hash.value;
+}
+
+void BatchResults::report(std::ostream& out) const {
+    size_t count = size();
+    if (count == 0) return;
+
+    auto median = [count](auto column) {
+        std::nth_element(column.begin(), column.begin() + count / 2, column.end());
+        return column[count / 2];
+    };
+    uint64_t totalTicks = std::accumulate(ticks.begin(), ticks.end(), uint64_t(0));
+    int64_t totalScore = std::accumulate(scores.begin(), scores.end(), int64_t(0));
+    size_t deaths = std::count(died.begin(), died.end(), uint8_t(1));
+
+    out << "  sessions: " << count << ", " << deaths << " game overs (" << 100.0 * deaths / count << "%)" << std::endl;
+    out << "  survival: mean " << double(totalTicks) / count << " ticks, median " << median(ticks)
+        << ", longest " << *std::max_element(ticks.begin(), ticks.end()) << std::endl;
+    out << "  score: mean " << double(totalScore) / count << ", median " << median(scores)
+        << ", best " << *std::max_element(scores.begin(), scores.end()) << std::endl;
+    out << "  peak objects: median " << median(peakObjects)
+        << ", most " << *std::max_element(peakObjects.begin(), peakObjects.end()) << std::endl;
+}
+
+BatchRunner::BatchRunner(const Settings& settings, JobSystem& jobs) :
+    settings(settings),
+    jobs(jobs)
+{
+    worlds.resize(settings.worlds);
+    results.resize(settings.worlds);
+
+    // built here on the calling thread, initHeadless reads (and may fill in) the display size globals
+    for (size_t i = 0; i < worlds.size(); i++) {
+        World& world = worlds[i];
+        world.window.reset(initHeadless());
+        world.game = std::make_unique<GameManager>(world.window.get());
+        world.game->getLodSettings().enabled = settings.simLod;
+        // seeded but not in deterministic mode, nobody looks at a per-step hash here
+        world.game->getContext().reseed(settings.firstSeed + i);
+        world.game->createPlayer();
+        results.seeds[i] = settings.firstSeed + i;
+    }
+}
+
+BatchRunner::~BatchRunner() {
+    // games point at their windows, they go first
+    for (World& world : worlds) {
+        world.game.reset();
+    }
+}
+
+void BatchRunner::run() {
+    auto stepRange = [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            stepWorld(i, settings.syncInterval);
+        }
+    };
+
+    size_t remaining = worlds.size();
+    while (remaining > 0) {
+        jobs.parallelFor(worlds.size(), 1, stepRange);
+        syncs++;
+        remaining = size_t(std::count_if(worlds.begin(), worlds.end(), [](const World& world) { return !world.done; }));
+    }
+}
+
+void BatchRunner::stepWorld(size_t index, uint64_t steps) {
+    World& world = worlds[index];
+    GameManager& game = *world.game;
+    float step = 1.0f / simulationHz;
+
+    for (uint64_t i = 0; i < steps && !world.done; i++) {
+        // whatever this thread ran before was a different world's step, none of it is live any more
+        frameArena().reset();
+
+        if (inputs) {
+            inputs(index, game, game.findPlayer());
+        }
+        world.window->update(step);
+        game.update(step);
+
+        // the player is gone once the death animation is over, keep what it had
+        if (Player* player = game.findPlayer()) {
+            results.scores[index] = player->getScore();
+        }
+        uint64_t tick = game.getClock().tick;
+        results.ticks[index] = tick;
+        results.peakObjects[index] = std::max(results.peakObjects[index], uint32_t(game.getGameObjects().size()));
+
+        bool gameOver = game.getGameState() == GameState::GAME_OVER;
+        if (gameOver || tick >= settings.maxTicks) {
+            results.died[index] = gameOver;
+            results.stateHashes[index] = game.computeStateHash();
+            world.done = true;
+        }
+    }
+}
@@ -2,6 +2,9 @@
 #include "../include/utils.h"
 #include "../include/player.h"
 #include "../include/window.h"
+#include "../include/render_snapshot.h"
+#include "../include/state_stream.h"
+#include "../include/sim_context.h"
 #include <iostream>
 #include <algorithm>
 
@@ -23,9 +26,11 @@ Beam::Beam(
     state(BeamState::WARNING),
     stateTimer(0.0f),
     warningDuration(1.5f),
+    hasExpandedWarning(false),
     expandDuration(0.2f),
     activeDuration(1.0f),
     fadeDuration(1.0f),
+    startEdge(startEdge),
     beamWidth(beamWidth),
     damage(2.0f),
     beamProgress(0.0f)
@@ -59,24 +64,52 @@ Beam::~Beam() {
     }
 }
 
-void Beam::draw(SDL_Renderer* renderer) {
-    if (!isActive) return;
+void Beam::saveState(StateWriter& out) const {
+    GameObject::saveState(out);
+    out.write(state);
+    out.write(stateTimer);
+    out.write(warningDuration);
+    out.write(hasExpandedWarning);
+    out.write(expandDuration);
+    out.write(activeDuration);
+    out.write(fadeDuration);
+    out.write(activeUntil);
+    out.write(fadeStartTick);
+    out.write(opacity);
+    out.write(direction);
+    out.write(startEdge);
+    out.write(beamProgress);
+    out.write(beamWidth);
+    out.write(damage);
+}
 
-    SDL_Rect windowBounds = window->getBounds();
-    /*if (!isInWindow(windowBounds)) {
-        return;
-    }
-        */
-    // runtime drawing
+void Beam::loadState(StateReader& in) {
+    GameObject::loadState(in);
+    in.read(state);
+    in.read(stateTimer);
+    in.read(warningDuration);
+    in.read(hasExpandedWarning);
+    in.read(expandDuration);
+    in.read(activeDuration);
+    in.read(fadeDuration);
+    in.read(activeUntil);
+    in.read(fadeStartTick);
+    in.read(opacity);
+    in.read(direction);
+    in.read(startEdge);
+    in.read(beamProgress);
+    in.read(beamWidth);
+    in.read(damage);
+}
 
-    Vector2D pos = getPosition();
-    Vector2D dim = getDimensions();
-    SDL_Rect rect = {
-        int(pos.x - window->x - dim.x/2),
-        int(pos.y - window->y - dim.y/2),
-        int(dim.x),
-        int(dim.y)
-    };
+bool Beam::writeSnapshot(RenderEntity& out) const {
+    if (!isActive) return false;
+
+    GameObject::writeSnapshot(out);
+    out.style = RenderStyle::FilledRect;
+    out.texture = nullptr;
+    // not interpolated, the beam's size changes every step and the edges have to stay glued to the window
+    out.interpolate = false;
 
     // color tinting
     // yellow: warning stage, white: active
@@ -95,73 +128,37 @@ void Beam::draw(SDL_Renderer* renderer) {
             break;
         case BeamState::FADING:
             r = 255; g = 255; b = 255;
-            float fadeProgress = std::min(stateTimer / fadeDuration, 1.0f);
-            a = Uint8(255 * (1.0f - fadeProgress)); // fade out
+            a = Uint8(255 * opacity); // fade out, see run()
             break;
     }
 
-    // Save the current blend mode
-    SDL_BlendMode oldBlendMode;
-    SDL_GetRenderDrawBlendMode(renderer, &oldBlendMode);
-    
-    // Set blend mode to enable alpha blending
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    
-    // Set color with alpha
-    SDL_SetRenderDrawColor(renderer, r, g, b, a);
-    SDL_RenderFillRect(renderer, &rect);
-    
-    // Restore the previous blend mode
-    SDL_SetRenderDrawBlendMode(renderer, oldBlendMode);
-
-    // uncomment if debug
-    // drawCollisionVertices(renderer);
-}
-
-void Beam::drawCollisionVertices(SDL_Renderer* renderer) const {
-    if (!isActive) return;
-
-    SDL_Rect windowBounds = window->getBounds();
-
-    // draw vertices at runtime
-    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-    for (size_t i = 0; i < vertices.size(); i++) {
-        const Vector2D& v1 = vertices[i];
-        const Vector2D& v2 = vertices[(i + 1) % vertices.size()];
-        SDL_RenderDrawLine(
-            renderer,
-            int(v1.x - window->x), int(v1.y - window->y),
-            int(v2.x - window->x), int(v2.y - window->y)
-        );
-    }
-    // draw center
-    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-    SDL_RenderDrawPoint(renderer, int(position.x - window->x), int(position.y - window->y));
+    out.color[0] = r; out.color[1] = g; out.color[2] = b; out.color[3] = a;
+    return true;
 }
 
 void Beam::expandTop(float delta) {
     float originalHeight = dimensions.y;
     dimensions.y += delta;
     position.y -= delta / 2.0f;
-    initRectangleCollision();
+    updateCollisionVertices();
 }
 
 void Beam::expandBottom(float delta) {
     dimensions.y += delta;
     position.y += delta / 2.0f;
-    initRectangleCollision();
+    updateCollisionVertices();
 }
 
 void Beam::expandLeft(float delta) {
     dimensions.x += delta;
     position.x -= delta / 2.0f;
-    initRectangleCollision();
+    updateCollisionVertices();
 }
 
 void Beam::expandRight(float delta) {
     dimensions.x += delta;
     position.x += delta / 2.0f;
-    initRectangleCollision();
+    updateCollisionVertices();
 }
 
 void Beam::expandByDirection(int direction, float delta, float compensate) {
@@ -188,10 +185,73 @@ void Beam::expandByDirection(int direction, float delta, float compensate) {
     }
 }
  
-void Beam::update(float deltaTime) {
+void Beam::update(const FrameClock&) {
+    // nothing per step, the script does it all (see run())
+}
+
+void Beam::scheduleTimers() {
     if (!isActive) return;
-    stateTimer += deltaTime;
+    context->scripts.stop(script);
+    script = context->scripts.start(run());
+}
+
+void Beam::cancelTimers() {
+    if (!context) return;
+    context->scripts.stop(script);
+    context->tweens.cancel(fadeTween);
+}
+
+// warning, expand, stay, fade. starts from whatever state the beam is in, so a restored beam just
+// picks up where it was
+ScriptTask Beam::run() {
+    ScriptScheduler& scripts = context->scripts;
+
+    while (state == BeamState::WARNING) {
+        stateTimer += scripts.getDeltaTime();
+        warningStep();
+        if (stateTimer >= warningDuration) {
+            state = BeamState::EXPANDING;
+            cerr << "Duration in warning state: " << stateTimer << endl;
+            stateTimer = 0.0f;
+        }
+        co_await nextTick();
+    }
+
+    while (state == BeamState::EXPANDING) {
+        stateTimer += scripts.getDeltaTime();
+        if (stateTimer >= expandDuration) {
+            state = BeamState::ACTIVE;
+            cerr << "Duration in expanding state: " << stateTimer << endl;
+            stateTimer = 0.0f;
+            activeUntil = scripts.now() + SimContext::ticksFor(activeDuration);
+        } else {
+            // proportional expansion based on stateTimer
+            expandStep(stateTimer / expandDuration);
+        }
+        co_await nextTick();
+    }
+
+    if (state == BeamState::ACTIVE) {
+        // nothing changes while it's fully out, sleep straight through
+        co_await waitUntil(activeUntil);
+        state = BeamState::FADING;
+        cerr << "Duration in active state: " << activeDuration << endl;
+        stateTimer = 0.0f;
+        fadeStartTick = scripts.now();
+    }
+
+    if (state == BeamState::FADING) {
+        // the tween does the fading, all that's left here is taking the beam away at the end
+        // (started again from fadeStartTick if this is a restored beam)
+        uint64_t fadeTicks = SimContext::ticksFor(fadeDuration);
+        context->tweens.cancel(fadeTween);
+        fadeTween = context->tweens.start(&opacity, 1.0f, 0.0f, fadeStartTick, fadeTicks);
+        co_await waitUntil(fadeStartTick + fadeTicks);
+        isActive = false;
+    }
+}
 
+void Beam::warningStep() {
     SDL_Rect windowBounds = window->getBounds();
     std::pair<int, int> screenResolution = getResolution();
 
@@ -201,90 +261,62 @@ void Beam::update(float deltaTime) {
     float targetExpandUp = screenResolution.second, targetExpandDown = screenResolution.second, targetExpandLeft= screenResolution.first, targetExpandRight = screenResolution.first;
     // so realistically it'll expand by 2x screen resolution both ways
     // not optimal but it works
-    
-    switch (state) {
-        case BeamState::WARNING:
-            if (!hasExpandedWarning) {
-                float warningExpandMultiplier = 0.05f;
-                switch (direction) {
-                    case 0: // Bottom
-                        expandBottom(targetExpandDown * warningExpandMultiplier);
-                        expandTop(targetExpandUp * warningExpandMultiplier);
-                        setDimensions(Vector2D(beamWidth, dim.y));
-                        break;
-                    case 1: // Top
-                        expandTop(targetExpandUp * warningExpandMultiplier);
-                        expandBottom(targetExpandDown * warningExpandMultiplier);
-                        setDimensions(Vector2D(beamWidth, dim.y));
-                        break;
-                    case 2: // Right
-                        expandRight(targetExpandRight * warningExpandMultiplier);
-                        expandLeft(targetExpandLeft * warningExpandMultiplier);
-                        setDimensions(Vector2D(dim.x, beamWidth));
-                        break;
-                    case 3: // Left
-                        expandLeft(targetExpandLeft * warningExpandMultiplier);
-                        expandRight(targetExpandRight * warningExpandMultiplier);
-                        setDimensions(Vector2D(dim.x, beamWidth));
-                        break;
-                }
-                hasExpandedWarning = true;
-            }
-            // attach to corresponding edge
-            switch (direction) {
-                case 0: setPosition(Vector2D(pos.x, windowBounds.y - dim.y + 20)); break;
-                case 1: setPosition(Vector2D(pos.x, windowBounds.y + windowBounds.h - 20)); break;
-                case 2: setPosition(Vector2D(windowBounds.x - dim.x + 20, pos.y)); break;
-                case 3: setPosition(Vector2D(windowBounds.x + windowBounds.w - 20, pos.y)); break;
-            }
-            if (stateTimer >= warningDuration) {
-                state = BeamState::EXPANDING;
-                cerr << "Duration in warning state: " << stateTimer << endl;
-                stateTimer = 0.0f;
-            }
-        break;
-    
-        case BeamState::EXPANDING:
-            if (stateTimer >= expandDuration) {
-                state = BeamState::ACTIVE;
-                cerr << "Duration in expanding state: " << stateTimer << endl;
-                stateTimer = 0.0f;
-            } else {
-                // proportional expansion based on stateTimer
-                switch (direction) {
-                    case 0: // Bottom
-                        expandBottom(targetExpandDown * (stateTimer / expandDuration));
-                        expandTop(targetExpandUp * (stateTimer / expandDuration));
-                        break;
-                    case 1: // Top
-                        expandTop(targetExpandUp * (stateTimer / expandDuration));
-                        expandBottom(targetExpandDown * (stateTimer / expandDuration));
-                        break;
-                    case 2: // Right
-                        expandRight(targetExpandRight * (stateTimer / expandDuration));
-                        expandLeft(targetExpandLeft * (stateTimer / expandDuration));
-                        break;
-                    case 3: // Left
-                        expandLeft(targetExpandLeft * (stateTimer / expandDuration));
-                        expandRight(targetExpandRight * (stateTimer / expandDuration));
-                        break;
-                }
-            }
-        break;
 
-        case BeamState::ACTIVE:
-            if (stateTimer >= activeDuration) {
-                state = BeamState::FADING;
-                cerr << "Duration in active state: " << stateTimer << endl;
-                stateTimer = 0.0f;
-            }
-        break;
-        
-        case BeamState::FADING:
-            if (stateTimer >= fadeDuration) {
-                isActive = false;
-            }
-        break;
+    if (!hasExpandedWarning) {
+        float warningExpandMultiplier = 0.05f;
+        switch (direction) {
+            case 0: // Bottom
+                expandBottom(targetExpandDown * warningExpandMultiplier);
+                expandTop(targetExpandUp * warningExpandMultiplier);
+                setDimensions(Vector2D(beamWidth, dim.y));
+                break;
+            case 1: // Top
+                expandTop(targetExpandUp * warningExpandMultiplier);
+                expandBottom(targetExpandDown * warningExpandMultiplier);
+                setDimensions(Vector2D(beamWidth, dim.y));
+                break;
+            case 2: // Right
+                expandRight(targetExpandRight * warningExpandMultiplier);
+                expandLeft(targetExpandLeft * warningExpandMultiplier);
+                setDimensions(Vector2D(dim.x, beamWidth));
+                break;
+            case 3: // Left
+                expandLeft(targetExpandLeft * warningExpandMultiplier);
+                expandRight(targetExpandRight * warningExpandMultiplier);
+                setDimensions(Vector2D(dim.x, beamWidth));
+                break;
         }
+        hasExpandedWarning = true;
+    }
+    // attach to corresponding edge
+    switch (direction) {
+        case 0: setPosition(Vector2D(pos.x, windowBounds.y - dim.y + 20)); break;
+        case 1: setPosition(Vector2D(pos.x, windowBounds.y + windowBounds.h - 20)); break;
+        case 2: setPosition(Vector2D(windowBounds.x - dim.x + 20, pos.y)); break;
+        case 3: setPosition(Vector2D(windowBounds.x + windowBounds.w - 20, pos.y)); break;
+    }
+}
+
+void Beam::expandStep(float progress) {
+    std::pair<int, int> screenResolution = getResolution();
+    float targetExpandUp = screenResolution.second, targetExpandDown = screenResolution.second, targetExpandLeft= screenResolution.first, targetExpandRight = screenResolution.first;
 
-}
\ No newline at end of file
+    switch (direction) {
+        case 0: // Bottom
+            expandBottom(targetExpandDown * progress);
+            expandTop(targetExpandUp * progress);
+            break;
+        case 1: // Top
+            expandTop(targetExpandUp * progress);
+            expandBottom(targetExpandDown * progress);
+            break;
+        case 2: // Right
+            expandRight(targetExpandRight * progress);
+            expandLeft(targetExpandLeft * progress);
+            break;
+        case 3: // Left
+            expandLeft(targetExpandLeft * progress);
+            expandRight(targetExpandRight * progress);
+            break;
+    }
+}
@@ -13,20 +13,36 @@ void CollisionManager::removeObject(GameObject* obj) {
     }
 }
 
+void CollisionManager::addObjects(const std::vector<GameObject*>& batch) {
+    objects.reserve(objects.size() + batch.size());
+    objects.insert(objects.end(), batch.begin(), batch.end());
+}
+
+void CollisionManager::removeInactiveObjects() {
+    objects.erase(
+        std::remove_if(objects.begin(), objects.end(),
+            [](GameObject* obj) { return !obj->getActive(); }
+        ),
+        objects.end()
+    );
+}
+
 void CollisionManager::checkCollisions() {
     // simple n^2
     // grid a bit too difficult and the number of objects isn't too large anyway
     int size = objects.size();
     for (int i = 0; i < size; i++) {
         GameObject* objA = objects[i];
-        if (!objA->getActive()) continue;
+        if (!objA->isAlive()) continue;
         
         for (int j = i + 1; j < size; j++) {
             GameObject* objB = objects[j];
-            if (!objB->getActive()) continue;
+            if (!objB->isAlive()) continue;
             
             if (objA->checkCollision(*objB)) {
                 handleCollision(objA, objB);
+                // despawns are deferred, but objA may have just been queued for one
+                if (!objA->isAlive()) break;
             }
         }
     }
@@ -0,0 +1,28 @@
+#include "../include/fixed_timestep.h"
+#include <algorithm>
+#include <cmath>
+
+FixedTimestep::FixedTimestep(float hz, int maxCatchUpSteps) :
+    step(1.0f / hz),
+    maxCatchUpSteps(std::max(1, maxCatchUpSteps))
+{}
+
+void FixedTimestep::addFrameTime(float frameTime) {
+    stepsThisFrame = 0;
+    accumulator += std::max(0.0f, frameTime);
+
+    // a hitch longer than the cap is dropped instead of simulated,
+    // the game slows down for a moment instead of teleporting everything
+    float maxAccumulated = step * maxCatchUpSteps;
+    if (accumulator > maxAccumulated) {
+        droppedSteps += int(std::floor((accumulator - maxAccumulated) / step));
+        accumulator = maxAccumulated;
+    }
+}
+
+bool FixedTimestep::consumeStep() {
+    if (accumulator < step) return false;
+    accumulator -= step;
+    stepsThisFrame++;
+    return true;
+}
@@ -0,0 +1,86 @@
+#include "../include/frame_arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+FrameArena::FrameArena(size_t blockSize) {
+    addBlock(blockSize);
+}
+
+void FrameArena::addBlock(size_t minSize) {
+    Block block;
+    block.size = minSize;
+    block.data = std::make_unique<std::byte[]>(minSize);
+    blocks.push_back(std::move(block));
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    if (bytes == 0) bytes = 1;
+
+    // try the current block, then any later block left over from a previous frame
+    while (current < blocks.size()) {
+        Block& block = blocks[current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        uintptr_t aligned = (base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        size_t newOffset = (aligned - base) + bytes;
+
+        if (newOffset <= block.size) {
+            usedBytes += newOffset - offset;
+            offset = newOffset;
+            peakBytes = std::max(peakBytes, usedBytes);
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        current++;
+        offset = 0;
+    }
+
+    // out of space, spill into a new block (at least double the last one)
+    addBlock(std::max(blocks.back().size * 2, bytes + alignment));
+    return allocate(bytes, alignment);
+}
+
+void FrameArena::reset() {
+    if (blocks.size() > 1) {
+        // the last frame didn't fit, grow to a single block that would have
+        size_t total = capacity();
+        blocks.clear();
+        addBlock(total);
+    }
+    current = 0;
+    offset = 0;
+    usedBytes = 0;
+}
+
+size_t FrameArena::capacity() const {
+    size_t total = 0;
+    for (const auto& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+FrameArena& frameArena() {
+    // one per thread, each thread resets its own at its own frame boundary
+    thread_local FrameArena arena;
+    return arena;
+}
+
+const char* frameFormat(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    int length = std::vsnprintf(nullptr, 0, format, args);
+    va_end(args);
+
+    if (length < 0) {
+        va_end(argsCopy);
+        return "";
+    }
+
+    char* buffer = static_cast<char*>(frameArena().allocate(length + 1, 1));
+    std::vsnprintf(buffer, length + 1, format, argsCopy);
+    va_end(argsCopy);
+    return buffer;
+}
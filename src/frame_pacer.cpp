@@ -0,0 +1,82 @@
+#include "../include/frame_pacer.h"
+#include <algorithm>
+#include <cmath>
+
+FramePacer::FramePacer(int fps, Mode mode, float spinMarginMs) :
+    mode(mode),
+    frequency(SDL_GetPerformanceFrequency())
+{
+    period = fps > 0 ? frequency / Uint64(fps) : 0;
+    spinMargin = Uint64(double(frequency) * spinMarginMs / 1000.0);
+    if (period == 0 && this->mode == Mode::Capped) {
+        this->mode = Mode::Uncapped; // no target, nothing to wait for
+    }
+}
+
+void FramePacer::start() {
+    lastFrameEnd = SDL_GetPerformanceCounter();
+    nextDeadline = lastFrameEnd + period;
+}
+
+void FramePacer::waitForNextFrame() {
+    if (mode != Mode::Capped) {
+        recordFrame(SDL_GetPerformanceCounter());
+        return;
+    }
+
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    // coarse sleep, leave the margin for the spin
+    if (now + spinMargin < nextDeadline) {
+        Uint64 sleepTicks = nextDeadline - now - spinMargin;
+        Uint32 sleepMs = Uint32(sleepTicks * 1000 / frequency);
+        if (sleepMs > 0) {
+            SDL_Delay(sleepMs);
+        }
+    }
+
+    // spin the rest, this is where the microsecond accuracy comes from
+    now = SDL_GetPerformanceCounter();
+    while (now < nextDeadline) {
+        now = SDL_GetPerformanceCounter();
+    }
+
+    double overshoot = double(now - nextDeadline) / frequency;
+    overshootTotal += overshoot;
+    overshootMax = std::max(overshootMax, overshoot);
+
+    nextDeadline += period;
+    // a frame that ran way long shouldn't make the next few frames rush to catch up
+    if (now >= nextDeadline) {
+        missedDeadlines++;
+        nextDeadline = now + period;
+    }
+
+    recordFrame(now);
+}
+
+void FramePacer::recordFrame(Uint64 now) {
+    double frameTime = double(now - lastFrameEnd) / frequency;
+    lastFrameEnd = now;
+
+    frames++;
+    double delta = frameTime - frameTimeMean;
+    frameTimeMean += delta / double(frames);
+    frameTimeM2 += delta * (frameTime - frameTimeMean);
+}
+
+double FramePacer::getFrameTimeStdDev() const {
+    return frames > 1 ? std::sqrt(frameTimeM2 / double(frames - 1)) : 0.0;
+}
+
+void FramePacer::report(std::ostream& out) const {
+    const char* modeName = mode == Mode::Capped ? "capped" : mode == Mode::VSync ? "vsync" : "uncapped";
+    double meanMs = frameTimeMean * 1000.0;
+    out << "frame pacer (" << modeName << "): " << frames << " frames, "
+        << meanMs << " ms mean (" << (meanMs > 0.0 ? 1000.0 / meanMs : 0.0) << " fps), "
+        << getFrameTimeStdDev() * 1e6 << " us stddev\n";
+    if (mode == Mode::Capped) {
+        out << "  overshoot " << getMeanOvershoot() * 1e6 << " us mean, "
+            << overshootMax * 1e6 << " us max, " << missedDeadlines << " missed deadlines\n";
+    }
+}
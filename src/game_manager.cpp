@@ -2,25 +2,26 @@
 #include "../include/player.h"
 #include "../include/utils.h"
 #include "../include/globals.h"
+#include "../include/alloc_tracker.h"
+#include "../include/render_snapshot.h"
+#include "../include/state_stream.h"
 #include <random>
 #include <algorithm>
 #include <ctime>
+#include <tuple>
 
 GameManager::GameManager(Window* window) : 
     window(window), 
-    spawnTimer(0.0f), 
-    spawnInterval(5.0f), 
-    beamTimer(0.0f), 
-    beamInterval(5.0f), 
-    pentagonTimer(0.0f), 
-    pentagonInterval(5.0f), 
     gameState(GameState::RUNNING), 
-    gameOverTimer(0.0f) {
+    gameOverTimer(0.0f),
+    spawnDirector(this, window) {
     
+    // random unless setSeed() is called
     std::random_device rd;
-    rng = std::mt19937(rd());
+    context.reseed((uint64_t(rd()) << 32) | rd());
     
     collisionManager.setGameManager(this);
+    spawnDirector.scheduleTimers();
 }
 
 GameManager::~GameManager() {}
@@ -33,8 +34,7 @@ void GameManager::spawnTriangle(Vector2D pos, Vector2D dir, Player* target) {
     
     int speedBase = 100;
     int speedRange = 50;
-    std::uniform_int_distribution<int> speedDist(speedBase - speedRange, speedBase + speedRange);
-    int speed = speedDist(rng);
+    int speed = context.randomInt(speedBase - speedRange, speedBase + speedRange);
     
     float health = 50.0f;
     float score = 10.0f;
@@ -45,12 +45,11 @@ void GameManager::spawnTriangle(Vector2D pos, Vector2D dir, Player* target) {
     
     triangle->setScore(score);
 
-    std::uniform_real_distribution<float> angleDist(0.0f, 2 * M_PI);
-    float angle = angleDist(rng);
+    float angle = context.randomFloat(0.0f, 2 * M_PI);
     triangle->setAngle(angle);
+    triangle->setSpinDirection(context.randomInt(0, 1) ? 1 : -1);
     
-    collisionManager.addObject(triangle.get());
-    gameObjects.push_back(std::move(triangle));
+    commandBuffer.spawn(std::move(triangle));
 }
 
 void GameManager::spawnBeam(Player* target) {
@@ -58,8 +57,7 @@ void GameManager::spawnBeam(Player* target) {
     
     SDL_Rect bounds = window->getBounds();
     
-    std::uniform_int_distribution<int> edgeDist(0, 3); // 0: top, 1: bottom, 2: left, 3: right
-    int startEdge = edgeDist(rng);
+    int startEdge = context.randomInt(0, 3); // 0: top, 1: bottom, 2: left, 3: right
     
     Vector2D targetPos = target->getPosition();
     Vector2D beamPos;
@@ -95,9 +93,8 @@ void GameManager::spawnBeam(Player* target) {
         beamPos, dims, scope, r, g, b, a, speed, startEdge, window, target, beamWidth
     );
     
-    // Add to game objects collection
-    collisionManager.addObject(beam.get());
-    gameObjects.push_back(std::move(beam));
+    // queued, added to game objects at the end of the frame
+    commandBuffer.spawn(std::move(beam));
 }
 
 void GameManager::spawnProjectile(Vector2D pos, Vector2D dir, int speed) {
@@ -110,50 +107,7 @@ void GameManager::spawnProjectile(Vector2D pos, Vector2D dir, int speed) {
         pos, dims, dir, scope, r, g, b, a, speed, window
     );
     
-    collisionManager.addObject(projectile.get());
-    gameObjects.push_back(std::move(projectile));
-}
-
-void GameManager::spawnRandomEnemy(Player* target) {
-    SDL_Rect bounds = window->getBounds();
-    
-    std::uniform_int_distribution<int> marginDist(50, 100);
-    int spawnMargin = marginDist(rng);
-
-    std::uniform_int_distribution<int> numEnemiesDist(1, 4);
-    int numEnemies = numEnemiesDist(rng);
-
-    for (int i = 0; i < numEnemies; ++i) {
-        Vector2D spawnPos;
-
-        std::uniform_int_distribution<int> edgeDist(0, 3);
-        int edge = edgeDist(rng); // Randomly select an edge (0: top, 1: bottom, 2: left, 3: right)
-
-        switch (edge) {
-            case 0: // Top edge
-                spawnPos.x = std::uniform_int_distribution<int>(bounds.x, bounds.x + bounds.w)(rng);
-                spawnPos.y = bounds.y - spawnMargin;
-                break;
-
-            case 1: // Bottom edge
-                spawnPos.x = std::uniform_int_distribution<int>(bounds.x, bounds.x + bounds.w)(rng);
-                spawnPos.y = bounds.y + bounds.h + spawnMargin;
-                break;
-            
-            case 2: // Left edge
-                spawnPos.x = bounds.x - spawnMargin;
-                spawnPos.y = std::uniform_int_distribution<int>(bounds.y, bounds.y + bounds.h)(rng);
-                break;
-
-            case 3: // Right edge
-                spawnPos.x = bounds.x + bounds.w + spawnMargin;
-                spawnPos.y = std::uniform_int_distribution<int>(bounds.y, bounds.y + bounds.h)(rng);
-                break;
-            }
-        
-            Vector2D spawnDir = (target->getPosition() - spawnPos).normalize();
-            spawnTriangle(spawnPos, spawnDir, target);
-        }
+    commandBuffer.spawn(std::move(projectile));
 }
 
 void GameManager::spawnPentagon(Vector2D pos, Player* player) {
@@ -164,38 +118,10 @@ void GameManager::spawnPentagon(Vector2D pos, Player* player) {
     auto pentagon = std::make_unique<Pentagon>(
         pos, dims, scope, window, player, health
     );
+    // random angle at init
+    pentagon->setAngle(context.randomInt(0, 359) * M_PI / 180.0f);
     
-    collisionManager.addObject(pentagon.get());
-    gameObjects.push_back(std::move(pentagon));
-}
-
-void GameManager::spawnPentagonGroup(Player* player) {
-    if (!player || !player->getActive()) return;
-    
-    std::uniform_int_distribution<int> numPentagonsDist(1, 3);
-    int numPentagons = numPentagonsDist(rng);
-    
-    SDL_Rect bounds = window->getBounds();
-    auto [screenW, screenH] = getResolution();
-    Vector2D playerPos = player->getPosition();
-    
-    for (int i = 0; i < numPentagons; ++i) {
-        Vector2D spawnPos;
-        float distance = 0.0f;
-        
-        // randomly select a position until find one 500 pixels away
-        do {
-            std::uniform_int_distribution<int> xDist(0, screenW);
-            std::uniform_int_distribution<int> yDist(0, screenH);
-            
-            spawnPos.x = xDist(rng);
-            spawnPos.y = yDist(rng);
-            
-            distance = (spawnPos - playerPos).magnitude();
-        } while (distance < 500.0f);
-        
-        spawnPentagon(spawnPos, player);
-    }
+    commandBuffer.spawn(std::move(pentagon));
 }
 
 void GameManager::update(float deltaTime) {
@@ -203,72 +129,424 @@ void GameManager::update(float deltaTime) {
         return;
     }
 
-    // search for player object
+    // the only place gameplay time moves forward
+    clock.advance(deltaTime);
+
+    // search for player object, count enemies for the spawn cap on the way
     Player* playerTarget = nullptr;
+    int liveEnemies = 0;
     for (auto& obj : gameObjects) {
         if (obj->getType() == GameObject::ObjectType::Player) {
             playerTarget = static_cast<Player*>(obj.get());
-            break;
+        } else if (obj->getActive() && obj->getType() != GameObject::ObjectType::Projectile) {
+            liveEnemies++;
         }
     }
 
-    // triangle spawn logic
-    spawnTimer += deltaTime;
-    if (spawnTimer >= spawnInterval) {
-        if (playerTarget) {
-            spawnRandomEnemy(playerTarget);
+    {
+        // whatever came due this step, before anything moves
+        ALLOC_SCOPE("scripts");
+        context.scripts.run(clock);
+        // after the scripts, anything they start this step already shows
+        context.tweens.advance(clock.tick);
+    }
+
+    {
+        ALLOC_SCOPE("spawning");
+        spawnDirector.update(playerTarget, liveEnemies);
+    }
+
+    {
+        ALLOC_SCOPE("entities");
+        updateEntities();
+    }
+
+    {
+        ALLOC_SCOPE("collision");
+        checkCollisions();
+    }
+
+    // frame boundary: everything queued this frame (input, spawn timers, collisions) lands here
+    ALLOC_SCOPE("cleanup");
+    flushCommands();
+    cleanupInactiveObjects();
+
+    if (context.deterministic) {
+        stateHash = computeStateHash();
+    }
+}
+
+void GameManager::setJobSystem(JobSystem* jobs) {
+    this->jobs = jobs;
+    context.effectQueues.assign(jobs ? jobs->getSlotCount() : 1, DeferredEffects());
+}
+
+void GameManager::updateEntities() {
+    // everyone's previous state first, updates read each other's previous state and only write their own
+    // lod tiers are picked here as well, from where things were at the start of the step
+    SDL_Rect view = window->getBounds();
+    lodCounts[0] = lodCounts[1] = lodCounts[2] = 0;
+    SimLodSettings lod = lodSettings;
+    lod.fullMargin *= quality.lodMargin;
+    lod.reducedMargin *= quality.lodMargin;
+    SwarmField& swarm = context.swarm;
+    swarm.begin(view);
+    for (auto& obj : gameObjects) {
+        if (obj->getActive()) {
+            switch (obj->getType()) {
+                case GameObject::ObjectType::Triangle: swarm.add(obj->getPosition()); break;
+                case GameObject::ObjectType::Player: swarm.setTarget(obj->getPosition()); break;
+                default: break;
+            }
+            obj->storePreviousState();
+            obj->addLodTime(clock.deltaTime);
+            if (obj->supportsLod()) {
+                obj->setLod(lod.enabled
+                    ? lod.pick(obj->getLod(), distanceToRect(obj->getPosition(), view))
+                    : SimLod::Full);
+                lodCounts[int(obj->getLod())]++;
+            }
         }
-        spawnTimer = 0.0f;
     }
-    
-    // beam spawn logic
-    beamTimer += deltaTime;
-    if (beamTimer >= beamInterval) {
-        if (playerTarget) {
-            spawnBeam(playerTarget);
+
+    swarm.build();
+
+    // updates only say how they want to move, the integrator moves everything at once afterwards
+    kinematics.reset(gameObjects.size());
+    auto updateRange = [this](size_t begin, size_t end) {
+        DeferredEffects& effects = context.effects();
+        FrameClock stepClock = clock;
+        for (size_t i = begin; i < end; i++) {
+            GameObject* obj = gameObjects[i].get();
+            if (!obj->getActive()) continue;
+
+            // staggered by index so the low rate objects don't all land on the same step
+            // skipped steps pile up in lodTime, stepping back up to full rate flushes them in one go
+            int interval = lodSettings.interval(obj->getLod());
+            if (interval > 1 && (clock.tick + i) % interval != 0) continue;
+
+            effects.source = uint32_t(i);
+            stepClock.deltaTime = obj->takeLodTime();
+            obj->update(stepClock);
+            kinematics.load(i, *obj, stepClock.deltaTime);
         }
-        beamTimer = 0.0f;
+    };
+    if (jobs) {
+        jobs->parallelFor(gameObjects.size(), entityGrain, updateRange);
+    } else {
+        updateRange(0, gameObjects.size());
     }
-    
-    // pentagon spawn logic
-    pentagonTimer += deltaTime;
-    if (pentagonTimer >= pentagonInterval) {
-        if (playerTarget) {
-            spawnPentagonGroup(playerTarget);
+    kinematics.run(jobs, entityGrain);
+
+    applyDeferredEffects();
+}
+
+void GameManager::applyDeferredEffects() {
+    bool gameOver = false;
+    size_t resizeCount = 0;
+    for (DeferredEffects& effects : context.effectQueues) {
+        gameOver |= effects.gameOver;
+        resizeCount += effects.resizes.size();
+    }
+
+    if (resizeCount > 0) {
+        // whichever thread ran an object, its requests land in the order a serial update would have made them
+        FrameVector<DeferredEffects::Resize> resizes;
+        resizes.reserve(resizeCount);
+        for (DeferredEffects& effects : context.effectQueues) {
+            resizes.insert(resizes.end(), effects.resizes.begin(), effects.resizes.end());
+        }
+        std::sort(resizes.begin(), resizes.end(), [](const auto& a, const auto& b) {
+            return std::tie(a.source, a.sequence) < std::tie(b.source, b.sequence);
+        });
+        for (const DeferredEffects::Resize& resize : resizes) {
+            window->createResizeRequest(resize.top, resize.bottom, resize.left, resize.right,
+                                        resize.initialSpeed, resize.duration);
         }
-        pentagonTimer = 0.0f;
     }
-    
+
+    for (DeferredEffects& effects : context.effectQueues) {
+        effects.clear();
+    }
+    if (gameOver) {
+        triggerGameOver();
+    }
+}
+
+void GameManager::captureInitialState() {
+    saveWorld(initialState);
+}
+
+Player* GameManager::findPlayer() {
     for (auto& obj : gameObjects) {
-        if (obj->getActive()) {
-            obj->update(deltaTime);
+        if (obj->getType() == GameObject::ObjectType::Player) {
+            return static_cast<Player*>(obj.get());
         }
     }
-    
-    checkCollisions();
-    cleanupInactiveObjects();
+    return nullptr;
 }
 
-void GameManager::draw(SDL_Renderer* renderer) {
+void GameManager::saveWorld(std::vector<uint8_t>& out) const {
+    // generators are a handful of integers, saved as raw bytes
+    static_assert(std::is_trivially_copyable_v<Pcg32> && std::is_trivially_copyable_v<RandomBatch>,
+                  "rng state is saved as raw bytes");
+
+    out.clear();
+    StateWriter writer(out);
+    writer.write(clock);
+    writer.write(gameState);
+    spawnDirector.saveState(writer);
+    writer.write(gameOverTimer);
+    writer.write(context.rng);
+    writer.write(context.batch);
+    writer.write(context.streamsIssued);
+    window->saveState(writer);
+
+    writer.write(uint32_t(gameObjects.size()));
     for (auto& obj : gameObjects) {
-        if (obj->getActive()) {
-            obj->draw(renderer);
+        // size prefix so loadWorld can look ahead for the player without parsing everything
+        writer.write(obj->getType());
+        size_t sizeAt = writer.position();
+        writer.write(uint32_t(0));
+        obj->saveState(writer);
+        writer.patch(sizeAt, uint32_t(writer.position() - sizeAt - sizeof(uint32_t)));
+    }
+}
+
+bool GameManager::loadWorld(const uint8_t* data, size_t size) {
+    StateReader reader(data, size);
+    reader.read(clock);
+    reader.read(gameState);
+    spawnDirector.loadState(reader);
+    reader.read(gameOverTimer);
+    reader.read(context.rng);
+    reader.read(context.batch);
+    reader.read(context.streamsIssued);
+    window->loadState(reader);
+
+    uint32_t objectCount = 0;
+    reader.read(objectCount);
+    size_t objectsStart = reader.position();
+
+    // enemies need the player pointer when they're built, so find out first whether there is one
+    bool hasPlayer = false;
+    for (uint32_t i = 0; i < objectCount && reader.ok(); i++) {
+        GameObject::ObjectType type;
+        uint32_t recordSize = 0;
+        reader.read(type);
+        reader.read(recordSize);
+        reader.skip(recordSize);
+        hasPlayer |= type == GameObject::ObjectType::Player;
+    }
+    if (!reader.ok()) {
+        std::cerr << "World state is truncated, not loading it" << std::endl;
+        return false;
+    }
+
+    // the player object survives loads (the sim thread holds on to it), everything else is rebuilt
+    std::unique_ptr<GameObject> playerObj = nullptr;
+    for (auto it = gameObjects.begin(); it != gameObjects.end(); ++it) {
+        if ((*it)->getType() == GameObject::ObjectType::Player) {
+            playerObj = std::move(*it);
+            gameObjects.erase(it);
+            break;
         }
     }
+    if (hasPlayer && !playerObj) {
+        playerObj = std::make_unique<Player>(Vector2D(0, 0), 25, 500.0f, window);
+        static_cast<Player*>(playerObj.get())->setGameManager(this);
+        playerObj->setContext(&context);
+    }
+    Player* player = hasPlayer ? static_cast<Player*>(playerObj.get()) : nullptr;
+
+    gameObjects.clear();
+    collisionManager.clear();
+    commandBuffer.clear(); // pending commands point at objects that are gone now
+    context.scripts.reset(clock.tick); // same for scripts and tweens, everyone starts theirs again below
+    context.tweens.reset(clock.tick);
+    spawnDirector.scheduleTimers();
+
+    StateReader objects(data + objectsStart, size - objectsStart);
+    spawnBatch.clear();
+    for (uint32_t i = 0; i < objectCount; i++) {
+        GameObject::ObjectType type;
+        uint32_t recordSize = 0;
+        objects.read(type);
+        objects.read(recordSize);
+
+        std::unique_ptr<GameObject> obj = type == GameObject::ObjectType::Player
+            ? std::move(playerObj)
+            : createBlankObject(type, player);
+        if (!obj) {
+            objects.skip(recordSize);
+            continue;
+        }
+        obj->setContext(&context);
+        obj->loadState(objects);
+        obj->scheduleTimers();
+
+        spawnBatch.push_back(obj.get());
+        gameObjects.push_back(std::move(obj));
+    }
+    collisionManager.addObjects(spawnBatch);
+    return true;
 }
 
-void GameManager::cleanupInactiveObjects() {
-    auto it = gameObjects.begin();
-    while (it != gameObjects.end()) {
-        if (!(*it)->getActive()) {
-            collisionManager.removeObject(it->get());
+std::unique_ptr<GameObject> GameManager::createBlankObject(GameObject::ObjectType type, Player* player) {
+    // constructor arguments only matter for the things loadState doesn't cover (window, target, texture)
+    switch (type) {
+        case GameObject::ObjectType::Triangle:
+            return std::make_unique<Triangle>(
+                Vector2D(0, 0), Vector2D(60, 51), Vector2D(0, 0), GameObject::Scope::GLOBAL,
+                255, 255, 0, 255, 0, window, player
+            );
+        case GameObject::ObjectType::Pentagon:
+            return std::make_unique<Pentagon>(
+                Vector2D(0, 0), Vector2D(100, 100), GameObject::Scope::GLOBAL, window, player
+            );
+        case GameObject::ObjectType::Projectile:
+            return std::make_unique<Projectile>(
+                Vector2D(0, 0), Vector2D(10, 10), Vector2D(0, 0), GameObject::Scope::LOCAL,
+                0, 255, 255, 255, 0, window
+            );
+        case GameObject::ObjectType::Beam:
+            return std::make_unique<Beam>(
+                Vector2D(0, 0), Vector2D(20, 20), GameObject::Scope::GLOBAL,
+                255, 0, 0, 255, 0, 0, window, player
+            );
+        default:
+            std::cerr << "Can't restore object of type " << int(type) << std::endl;
+            return nullptr;
+    }
+}
+
+void GameManager::setSeed(uint64_t seed) {
+    context.deterministic = true;
+    context.reseed(seed);
+}
+
+uint64_t GameManager::computeStateHash() const {
+    StateHash hash;
+    hash.add(clock.tick);
+    hash.add(gameState);
+    spawnDirector.addToHash(hash);
+
+    SDL_Rect bounds = window->getBounds();
+    hash.add(bounds.x);
+    hash.add(bounds.y);
+    hash.add(bounds.w);
+    hash.add(bounds.h);
+
+    for (auto& obj : gameObjects) {
+        hash.add(obj->getType());
+        hash.add(obj->getActive());
+        Vector2D position = obj->getPosition();
+        Vector2D direction = obj->getDirection();
+        Vector2D dimensions = obj->getDimensions();
+        hash.add(position.x);
+        hash.add(position.y);
+        hash.add(direction.x);
+        hash.add(direction.y);
+        hash.add(dimensions.x);
+        hash.add(dimensions.y);
+        hash.add(obj->getAngle());
+
+        switch (obj->getType()) {
+            case GameObject::ObjectType::Player: {
+                Player* player = static_cast<Player*>(obj.get());
+                hash.add(player->getHealth());
+                hash.add(player->getScore());
+                break;
+            }
+            case GameObject::ObjectType::Triangle:
+                hash.add(static_cast<Triangle*>(obj.get())->getHealth());
+                break;
+            case GameObject::ObjectType::Pentagon:
+                hash.add(static_cast<Pentagon*>(obj.get())->getHealth());
+                break;
+            case GameObject::ObjectType::Beam:
+                hash.add(static_cast<Beam*>(obj.get())->getState());
+                break;
+            default:
+                break;
+        }
+    }
+    return hash.value;
+}
+
+void GameManager::flushCommands() {
+    spawnBatch.clear();
+    commandBuffer.apply([this](CommandBuffer::Command&& command) {
+        switch (command.type) {
+            case CommandBuffer::CommandType::Spawn:
+                command.object->setContext(&context);
+                command.object->setRandom(context.entityStream());
+                command.object->scheduleTimers();
+                spawnBatch.push_back(command.object.get());
+                gameObjects.push_back(std::move(command.object));
+                break;
+            case CommandBuffer::CommandType::Despawn:
+                command.target->setActive(false);
+                break;
+        }
+    });
+
+    // one bulk insert instead of a push per spawn
+    if (!spawnBatch.empty()) {
+        collisionManager.addObjects(spawnBatch);
+    }
+}
+
+void GameManager::buildSnapshot(RenderSnapshot& snapshot) {
+    snapshot.clear();
+    snapshot.windowBounds = window->getBounds();
+    snapshot.gameState = gameState;
+
+    for (auto& obj : gameObjects) {
+        if (!obj->getActive()) continue;
+
+        if (obj->getType() == GameObject::ObjectType::Player) {
+            Player* player = static_cast<Player*>(obj.get());
+            snapshot.hasPlayer = true;
+            snapshot.playerHealth = player->getHealth();
+            snapshot.playerMaxHealth = player->getMaxHealth();
+            snapshot.playerScore = player->getScore();
+        }
+
+        RenderEntity entity;
+        if (!obj->writeSnapshot(entity)) continue;
+        if (!quality.healthBars) {
+            entity.healthRatio = -1.0f;
+        }
+        if (debugCollisionHulls && quality.debugOverlays) {
+            obj->writeDebugHull(entity, snapshot);
         }
-        ++it;
+        snapshot.entities.push_back(entity);
     }
+}
+
+void GameManager::setQuality(const QualityKnobs& knobs) {
+    quality.healthBars = knobs.healthBars;
+    quality.debugOverlays = knobs.debugOverlays;
+    if (context.deterministic) return;
+
+    quality.spawnRate = knobs.spawnRate;
+    quality.cosmetics = knobs.cosmetics;
+    quality.lodMargin = knobs.lodMargin;
+    context.cosmetics = knobs.cosmetics;
+    spawnDirector.getSettings().rateScale = knobs.spawnRate;
+}
+
+void GameManager::cleanupInactiveObjects() {
+    collisionManager.removeInactiveObjects();
     
     gameObjects.erase(
         std::remove_if(gameObjects.begin(), gameObjects.end(), 
-            [](const std::unique_ptr<GameObject>& obj) { return !obj->getActive(); }
+            [](const std::unique_ptr<GameObject>& obj) {
+                if (obj->getActive()) return false;
+                obj->cancelTimers();
+                return true;
+            }
         ),
         gameObjects.end()
     );
@@ -293,12 +571,11 @@ void GameManager::handleCollision(GameObject* a, GameObject* b) {
         Triangle* triangle = (typeA == GameObject::ObjectType::Triangle) ? 
             static_cast<Triangle*>(a) : static_cast<Triangle*>(b);
         
-        if (projectile->getActive() && triangle->getActive()) {
+        if (projectile->isAlive() && triangle->isAlive()) {
             triangle->changeHealthBy(-10.0f);
-            triangle->setLastHitTime(SDL_GetTicks() / 1000.0f);
-            triangle->setColor(255, 255, 255, 255);
+            triangle->flash(clock);
             
-            projectile->setActive(false);
+            despawn(projectile);
             
             if (triangle->getHealth() <= 0) {
                 Player* player = nullptr;
@@ -315,7 +592,7 @@ void GameManager::handleCollision(GameObject* a, GameObject* b) {
                     std::cerr << "Triangle destroyed! Add " << scoreValue << " points to player." << std::endl;
                 }
                 
-                triangle->setActive(false);
+                despawn(triangle);
             }
         }
     }
@@ -330,11 +607,11 @@ void GameManager::handleCollision(GameObject* a, GameObject* b) {
         Pentagon* pentagon = (typeA == GameObject::ObjectType::Pentagon) ? 
             static_cast<Pentagon*>(a) : static_cast<Pentagon*>(b);
         
-        if (projectile->getActive() && pentagon->getActive()) {
+        if (projectile->isAlive() && pentagon->isAlive()) {
             pentagon->changeHealthBy(-10.0f);
-            pentagon->setLastHitTime(SDL_GetTicks() / 1000.0f);
+            pentagon->flash(clock);
             
-            projectile->setActive(false);
+            despawn(projectile);
             
             if (pentagon->getHealth() <= 0) {
                 // Find the player to award score
@@ -352,7 +629,7 @@ void GameManager::handleCollision(GameObject* a, GameObject* b) {
                     std::cerr << "Pentagon destroyed! Add " << scoreValue << " points to player." << std::endl;
                 }
                 
-                pentagon->setActive(false);
+                despawn(pentagon);
             }
         }
     }
@@ -367,13 +644,13 @@ void GameManager::handleCollision(GameObject* a, GameObject* b) {
         Player* player = (typeA == GameObject::ObjectType::Player) ? 
             static_cast<Player*>(a) : static_cast<Player*>(b);
         
-        if (triangle->getActive() && player->getActive()) {
+        if (triangle->isAlive() && player->isAlive()) {
             if (player->isInDeathAnimation()) {
                 return;
             }
             
             // Deal damage to player
-            player->changeHealthBy(-1);
+            player->changeHealthBy(-1, clock.now());
             
             // Calculate and apply knockback
             float knockbackFactor = 50.0f;
@@ -399,12 +676,12 @@ void GameManager::handleCollision(GameObject* a, GameObject* b) {
         Player* player = (typeA == GameObject::ObjectType::Player) ? 
             static_cast<Player*>(a) : static_cast<Player*>(b);
         
-        if (pentagon->getActive() && player->getActive()) {
+        if (pentagon->isAlive() && player->isAlive()) {
             if (player->isInDeathAnimation()) {
                 return;
             }
             
-            player->changeHealthBy(-1);
+            player->changeHealthBy(-1, clock.now());
             
             float knockbackFactor = 50.0f;
             Vector2D playerPos = player->getPosition();
@@ -427,14 +704,14 @@ void GameManager::handleCollision(GameObject* a, GameObject* b) {
         Player* player = (typeA == GameObject::ObjectType::Player) ? 
             static_cast<Player*>(a) : static_cast<Player*>(b);
         
-        if (beam->getActive() && player->getActive()) {
+        if (beam->isAlive() && player->isAlive()) {
             if (player->isInDeathAnimation()) {
                 return;
             }
             
             Beam::BeamState beamState = beam->getState();
             if (beamState == Beam::BeamState::ACTIVE || beamState == Beam::BeamState::EXPANDING) {
-                player->changeHealthBy(-2);
+                player->changeHealthBy(-2, clock.now());
             }
         }
     }
@@ -456,7 +733,30 @@ void GameManager::handleCollision(GameObject* a, GameObject* b) {
     }
 }
 
+Player* GameManager::createPlayer() {
+    SDL_Rect bounds = window->getBounds();
+    int startX = bounds.x + bounds.w/2;
+    int startY = bounds.y + bounds.h/2;
+    float playerSpeed = 500.0f;
+    int playerRadius = 25;
+
+    // allocate Player on the heap and hand to manager
+    auto player = std::make_unique<Player>(
+        Vector2D(startX, startY),
+        playerRadius,
+        playerSpeed,
+        window
+    );
+    Player* playerPtr = player.get();
+    playerPtr->setGameManager(this);
+    addObject(std::move(player));
+    return playerPtr;
+}
+
 void GameManager::addObject(std::unique_ptr<GameObject> obj) {
+    obj->setContext(&context);
+    obj->setRandom(context.entityStream());
+    obj->scheduleTimers();
     collisionManager.addObject(obj.get());
     gameObjects.push_back(std::move(obj));
 }
@@ -481,86 +781,18 @@ void GameManager::resumeGame() {
 }
 
 void GameManager::restartGame() {
-    gameState = GameState::RUNNING;
-    
-    // Reset window to original dimensions and position
-    std::pair<int,int> resolution = getResolution();
-    int centerX = (resolution.first - windowWidth) / 2;
-    int centerY = (resolution.second - windowHeight) / 2;
-    
-    // Reset window to original size and position
-    if (window) {
-        window->setSize(windowWidth, windowHeight);
-        window->setPos(centerX, centerY);
-        
-        window->clearResizeRequests();
-    }
-    
-    std::unique_ptr<GameObject> playerObj = nullptr;
-
-    // find player
-    for (auto it = gameObjects.begin(); it != gameObjects.end(); ++it) {
-        if ((*it)->getType() == GameObject::ObjectType::Player) {
-            playerObj = std::move(*it);
-            gameObjects.erase(it);
-            break;
-        }
+    if (initialState.empty()) {
+        std::cerr << "No initial state captured, can't restart" << std::endl;
+        return;
     }
-    
-    gameObjects.clear();
-    collisionManager.clear();
-    
-    spawnTimer = 0.0f;
-    beamTimer = 0.0f;
-    pentagonTimer = 0.0f;
-    gameOverTimer = 0.0f;
-    
-    if (playerObj) {
-        Player* player = static_cast<Player*>(playerObj.get());
-        
-        SDL_Rect bounds = window->getBounds();
-        int startX = bounds.x + bounds.w/2;
-        int startY = bounds.y + bounds.h/2;
-        
-        player->setPosition(Vector2D(startX, startY));
-        player->resetHealth();
-        player->resetScore();
-        player->resetDeathState();
-        player->setActive(true);
-        
-        player->setDimensions(Vector2D(50, 50));
-        player->setColor(255, 255, 255, 255);
-        
-        player->reinitializeCollision();
-        
-        collisionManager.addObject(playerObj.get());
-        gameObjects.push_back(std::move(playerObj));
 
-    } else { 
-        std::cerr << "No player found, creating a new one" << std::endl;
-        
-        SDL_Rect bounds = window->getBounds();
-        int startX = bounds.x + bounds.w/2;
-        int startY = bounds.y + bounds.h/2;
-        float playerSpeed = 500.0f;
-        int playerRadius = 25;
-        
-        auto newPlayer = std::make_unique<Player>(
-            Vector2D(startX, startY),
-            playerRadius,
-            playerSpeed,
-            window
-        );
-        
-        Player* newPlayerPtr = newPlayer.get();
-        newPlayerPtr->setGameManager(this);
+    // the initial keyframe has everything: centered window, fresh player, zeroed timers and clock
+    loadWorld(initialState.data(), initialState.size());
 
-        // just to be sure
-        newPlayerPtr->setDimensions(Vector2D(50, 50));
-        newPlayerPtr->setPosition(Vector2D(startX, startY));
-        
-        collisionManager.addObject(newPlayer.get());
-        gameObjects.push_back(std::move(newPlayer));
+    // a seeded run replays the same rng stream (it's part of the keyframe), otherwise roll a new one
+    if (!context.deterministic) {
+        std::random_device rd;
+        context.reseed((uint64_t(rd()) << 32) | rd());
     }
     
     std::cerr << "Game restarted" << std::endl;
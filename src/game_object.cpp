@@ -1,5 +1,7 @@
 #include "../include/entities.h"
 #include "../include/utils.h"
+#include "../include/render_snapshot.h"
+#include "../include/state_stream.h"
 #include <iostream>
 #include <string>
 #include <cmath>
@@ -17,11 +19,57 @@ GameObject::GameObject(Vector2D pos, Vector2D dims, Vector2D dir,
     scope(scope),
     speed(speed), 
     isActive(true), 
-    angle(0.0f) 
+    angle(0.0f),
+    previousPosition(pos),
+    previousAngle(0.0f),
+    texture(nullptr)
 {
     color[0] = r; color[1] = g; color[2] = b; color[3] = a;
 }
 
+void GameObject::saveState(StateWriter& out) const {
+    out.write(position);
+    out.write(dimensions);
+    out.write(direction);
+    out.write(angle);
+    out.write(previousPosition);
+    out.write(previousAngle);
+    out.write(color);
+    out.write(scope);
+    out.write(isActive);
+    out.write(speed);
+    out.write(random);
+    out.write(lod);
+    out.write(lodTime);
+    // velocity and spin are used up within a step, only what carries over to the next one
+    out.write(motion.impulse);
+    out.write(motion.drift);
+    out.write(motion.burst);
+    out.write(motion.burstTime);
+}
+
+void GameObject::loadState(StateReader& in) {
+    in.read(position);
+    in.read(dimensions);
+    in.read(direction);
+    in.read(angle);
+    in.read(previousPosition);
+    in.read(previousAngle);
+    in.read(color);
+    in.read(scope);
+    in.read(isActive);
+    in.read(speed);
+    in.read(random);
+    in.read(lod);
+    in.read(lodTime);
+    in.read(motion.impulse);
+    in.read(motion.drift);
+    in.read(motion.burst);
+    in.read(motion.burstTime);
+    despawnQueued = false;
+    updateCollisionVertices();
+}
+
 GameObject::~GameObject() {
     texture = nullptr;
 }
@@ -59,9 +107,34 @@ void GameObject::rotate(float dAngle) {
 
 }
 
+// --- rendering ---------------------------------------------
+bool GameObject::writeSnapshot(RenderEntity& out) const {
+    out.style = RenderStyle::Sprite;
+    out.texture = texture;
+    out.previousPosition = previousPosition;
+    out.position = position;
+    out.previousAngle = previousAngle;
+    out.angle = angle;
+    out.interpolate = true;
+    out.dimensions = dimensions;
+    out.color[0] = color[0]; out.color[1] = color[1]; out.color[2] = color[2]; out.color[3] = color[3];
+    out.healthRatio = -1.0f;
+    out.hullCount = 0;
+    return texture != nullptr;
+}
+
+void GameObject::writeDebugHull(RenderEntity& out, RenderSnapshot& snapshot) const {
+    out.hullOffset = int(snapshot.debugHulls.size());
+    out.hullCount = int(vertices.size());
+    snapshot.debugHulls.insert(snapshot.debugHulls.end(), vertices.begin(), vertices.end());
+}
+
 // --- state management --------------------------------------
 void GameObject::setActive(bool active) {
     isActive = active;
+    if (active) {
+        despawnQueued = false;
+    }
 }
 
 void GameObject::setScope(Scope scope) {
@@ -103,53 +176,65 @@ std::vector<Vector2D> GameObject::getCollisionVertices() const {
 
 void GameObject::setCollisionVertices(const std::vector<Vector2D>& vertices) {
     this->vertices = vertices;
+    FrameVector<Vector2D> newAxes = getAxes(vertices);
+    axes.assign(newAxes.begin(), newAxes.end());
 }
 
 void GameObject::initRectangleCollision() {
-    localVertices = {
-        Vector2D(-dimensions.x / 2, -dimensions.y / 2),
-        Vector2D(+dimensions.x / 2, -dimensions.y / 2),
-        Vector2D(+dimensions.x / 2, +dimensions.y / 2),
-        Vector2D(-dimensions.x / 2, +dimensions.y / 2)
-    }; // doesn't really need the plus sign but it's there
-    updateCollisionVertices();
+    setShape(ShapeKind::Rectangle);
 }
 
 void GameObject::initCircleCollision() {
-    // magic number
-    // todo: how many vertices is a "good enough" approximation?
-    int numVertices = 12; // approximation
-    vertices.clear();
-    localVertices.clear();
-    for (int i = 0; i < numVertices; i++) {
-        float a = (2 * M_PI / numVertices) * i;
-        Vector2D vertex {
-            (dimensions.x / 2.0f) * cos(a),
-            (dimensions.y / 2.0f) * sin(a)
-        };
-        localVertices.push_back(vertex);
-    }
+    setShape(ShapeKind::Circle);
+}
+
+void GameObject::setShape(ShapeKind kind) {
+    shape = &ShapeLibrary::get(kind);
     updateCollisionVertices();
 }
 
+float GameObject::getBoundingRadius() const {
+    if (!shape) return 0.0f;
+    return ShapeLibrary::boundingRadius(*shape, dimensions);
+}
+
 void GameObject::updateCollisionVertices() {
     vertices.clear();
+    axes.clear();
+    if (!shape) return;
+
     float c = cos(angle), s = sin(angle);
-    for (auto& vertex : localVertices) {
-        float x = vertex.x * c - vertex.y * s;
-        float y = vertex.x * s + vertex.y * c;
-        vertices.push_back(Vector2D(x, y) + position);
+    float sx = dimensions.x, sy = dimensions.y;
+    for (int i = 0; i < shape->count; i++) {
+        // scale the unit hull, rotate, translate
+        const Vector2D& vertex = shape->vertices[i];
+        float lx = vertex.x * sx, ly = vertex.y * sy;
+        vertices.push_back(Vector2D(lx * c - ly * s, lx * s + ly * c) + position);
+
+        // an edge scaled by (sx, sy) has its normal scaled by (sy, sx)
+        const Vector2D& normal = shape->normals[i];
+        float nx = normal.x * sy, ny = normal.y * sx;
+        axes.push_back(Vector2D(nx * c - ny * s, nx * s + ny * c));
     }
 }
 
 // --- sat implementation -----------------------------------
 bool GameObject::checkCollision(const GameObject& other) {
-    return checkSATCollision(vertices, other.vertices);
+    // cheap bounding circle reject before sat
+    float reach = getBoundingRadius() + other.getBoundingRadius();
+    if ((position - other.position).lengthSquared() > reach * reach) {
+        return false;
+    }
+    // normals are precomputed per prototype, so no axes to rebuild here
+    return overlapsOnAxes(axes, vertices, other.vertices) &&
+           overlapsOnAxes(other.axes, vertices, other.vertices);
 }
 
-vector<Vector2D> GameObject::getAxes(const std::vector<Vector2D>& vertices) {
-    vector<Vector2D> axes;
+FrameVector<Vector2D> GameObject::getAxes(const std::vector<Vector2D>& vertices) {
+    // axes only live for one sat test, so they come from the frame arena
+    FrameVector<Vector2D> axes;
     size_t numVertices = vertices.size();
+    axes.reserve(numVertices);
     for (size_t i = 0; i < numVertices; i++) {
         Vector2D p1 = vertices[i];
         Vector2D p2 = vertices[(i + 1) % numVertices];
@@ -178,22 +263,38 @@ void GameObject::project(
     }
 }
 
-bool GameObject::checkSATCollision(
+bool GameObject::overlapsOnAxes(
+    const vector<Vector2D>& axes,
     const vector<Vector2D>& vertices1,
     const vector<Vector2D>& vertices2)
 {
-    vector<Vector2D> axes1 = getAxes(vertices1), axes2 = getAxes(vertices2);
-    vector<Vector2D> axes;
-    axes.insert(axes.end(), axes1.begin(), axes1.end());
-    axes.insert(axes.end(), axes2.begin(), axes2.end());
-    
-    for (auto& axis : axes) {
+    for (const auto& axis : axes) {
         float min1, max1, min2, max2;
         project(vertices1, axis, min1, max1);
         project(vertices2, axis, min2, max2);
-        
+
         if (max1 < min2 || max2 < min1) {
-            return false; // no collision, exit
+            return false; // found a separating axis
+        }
+    }
+    return true;
+}
+
+bool GameObject::checkSATCollision(
+    const vector<Vector2D>& vertices1,
+    const vector<Vector2D>& vertices2)
+{
+    // test both axis sets in place instead of merging them into a third vector
+    FrameVector<Vector2D> axes1 = getAxes(vertices1), axes2 = getAxes(vertices2);
+    for (const FrameVector<Vector2D>* axes : {&axes1, &axes2}) {
+        for (const auto& axis : *axes) {
+            float min1, max1, min2, max2;
+            project(vertices1, axis, min1, max1);
+            project(vertices2, axis, min2, max2);
+
+            if (max1 < min2 || max2 < min1) {
+                return false; // no collision, exit
+            }
         }
     }
     return true; // collision detected
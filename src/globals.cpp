@@ -11,22 +11,10 @@ int windowWidth = 800;
 int windowHeight = 800;
 int screenFPS = 60;
 int screenTicksPerFrame = 1000 / screenFPS;
+int simulationHz = 120;
+int maxCatchUpSteps = 8;
 int displayWidth = 0;
 int displayHeight = 0;
+bool debugCollisionHulls = false;
 
-std::map<std::string, bool> keyState = {
-    {"up", false},
-    {"down", false},
-    {"left", false},
-    {"right", false},
-    {"j", false}  // test key
-};
-
-// bool mouseState[3] = {false, false, false}; // Left, Middle, Right
-map<string, bool> mouseState = {
-    {"left", false},
-    {"middle", false},
-    {"right", false}
-};
-
-int mouseX, mouseY;
\ No newline at end of file
+// keyboard and mouse state moved to InputState (input_state.h), one per game
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include "../include/headless.h"
+#include "../include/game_manager.h"
+#include "../include/globals.h"
+#include "../include/utils.h"
+#include "../include/frame_arena.h"
+#include "../include/alloc_tracker.h"
+#include "../include/rewind_buffer.h"
+#include "../include/input_recording.h"
+#include "../include/simulation_thread.h"
+#include "../include/job_system.h"
+#include "../include/batch_runner.h"
+#include "../include/autopilot.h"
+#include "../include/quality_governor.h"
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+static int runReplay(const char* path, float autopilot, JobSystem& jobs) {
+    auto recording = std::make_unique<InputReplay>();
+    if (!recording->open(path)) return 1;
+
+    // same world the recording started in
+    const RecordingHeader& header = recording->getHeader();
+    displayWidth = header.displayWidth;
+    displayHeight = header.displayHeight;
+    Window* window = initHeadless();
+
+    GameManager gameManager(window);
+    gameManager.setJobSystem(&jobs);
+    gameManager.setSeed(header.seed);
+    if (autopilot >= 0.0f) {
+        // the recording has the autopilot's input but not the spawner settings it ran with
+        Autopilot(autopilot, header.seed).applyPressure(gameManager.getSpawnDirector().getSettings());
+    }
+    Player* player = gameManager.createPlayer();
+    gameManager.captureInitialState();
+
+    uint64_t steps = recording->getEndStep();
+    size_t events = recording->getEventCount();
+    SimulationThread simulation(gameManager, window, player);
+    simulation.startReplay(std::move(recording));
+
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+    bool match = simulation.runReplayToEnd();
+    double seconds = double(SDL_GetPerformanceCounter() - start) / frequency;
+
+    std::cout << "replay: " << steps << " steps, " << events << " events in " << seconds << " s ("
+              << (seconds > 0.0 ? steps / seconds : 0.0) << " steps/s)" << std::endl;
+    std::cout << "  state hash " << std::hex << gameManager.computeStateHash() << std::dec
+              << (match ? "" : " (does not match the recording)") << std::endl;
+
+    delete window;
+    return match ? 0 : 1;
+}
+
+static int runBatch(const HeadlessOptions& options, JobSystem& jobs) {
+    BatchRunner::Settings settings;
+    settings.worlds = options.batchWorlds;
+    settings.firstSeed = options.seeded ? options.seed : 1;
+    settings.maxTicks = options.ticks;
+    settings.syncInterval = std::max<uint64_t>(options.batchSync, 1);
+    settings.simLod = options.simLod;
+
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+    BatchRunner batch(settings, jobs);
+    // one autopilot per world, each only ever touched by the thread stepping its world
+    std::vector<Autopilot> pilots;
+    if (options.autopilot >= 0.0f) {
+        pilots.reserve(batch.getWorldCount());
+        for (size_t i = 0; i < batch.getWorldCount(); i++) {
+            pilots.emplace_back(options.autopilot, settings.firstSeed + i);
+            pilots.back().applyPressure(batch.getGame(i).getSpawnDirector().getSettings());
+        }
+        batch.setInputs([&pilots](size_t world, GameManager& game, Player*) {
+            pilots[world].drive(game, [&game](const SDL_Event& event) { Autopilot::deliver(game, event); });
+        });
+    }
+    double setupSeconds = double(SDL_GetPerformanceCounter() - start) / frequency;
+
+    start = SDL_GetPerformanceCounter();
+    batch.run();
+    double seconds = double(SDL_GetPerformanceCounter() - start) / frequency;
+
+    const BatchResults& results = batch.getResults();
+    uint64_t steps = 0;
+    for (uint64_t ticks : results.ticks) steps += ticks;
+
+    std::cout << "batch: " << results.size() << " worlds, " << steps << " steps in " << seconds << " s (setup "
+              << setupSeconds << " s)" << std::endl;
+    std::cout << "  " << (seconds > 0.0 ? steps / seconds : 0.0) << " steps/s, "
+              << (seconds > 0.0 ? double(steps) / simulationHz / seconds : 0.0) << "x real time over "
+              << jobs.getSlotCount() << " threads, " << batch.getSyncs() << " lockstep syncs" << std::endl;
+    results.report(std::cout);
+    std::cout << "  combined state hash " << std::hex << results.combinedHash() << std::dec << std::endl;
+    return 0;
+}
+
+int runHeadless(const HeadlessOptions& options) {
+    JobSystem jobs(options.workers < 0 ? JobSystem::defaultWorkerCount() : unsigned(options.workers));
+    if (options.replayPath) {
+        return runReplay(options.replayPath, options.autopilot, jobs);
+    }
+    if (options.batchWorlds > 0) {
+        return runBatch(options, jobs);
+    }
+
+    Window* window = initHeadless();
+
+    GameManager gameManager(window);
+    gameManager.setJobSystem(&jobs);
+    gameManager.getLodSettings().enabled = options.simLod;
+    if (options.seeded) {
+        gameManager.setSeed(options.seed);
+    }
+    std::unique_ptr<Autopilot> autopilot;
+    if (options.autopilot >= 0.0f) {
+        autopilot = std::make_unique<Autopilot>(options.autopilot, gameManager.getContext().seed);
+        autopilot->applyPressure(gameManager.getSpawnDirector().getSettings());
+    }
+    gameManager.createPlayer();
+    gameManager.captureInitialState();
+
+    std::unique_ptr<QualityGovernor> governor;
+    if (options.qualityBudget > 0.0f) {
+        QualityGovernor::Settings quality;
+        quality.budget = options.qualityBudget;
+        quality.window = 240; // steps come a lot faster than frames
+        quality.evaluateEvery = 30;
+        governor = std::make_unique<QualityGovernor>(quality);
+    }
+    // (tick, level) at every change, the knobs aren't in the saved world either
+    std::vector<std::pair<uint64_t, int>> levelChanges = {{0, 0}};
+
+    // what the autopilot held and pressed on which tick, the rewind check below has to feed it in again
+    // (neither the autopilot nor the input are in the saved world). only as far back as the rewind history goes
+    std::deque<std::pair<uint64_t, InputState>> held;
+    std::deque<std::pair<uint64_t, SDL_Event>> pressed;
+
+    std::unique_ptr<RewindBuffer> rewind;
+    std::vector<uint8_t> world;
+    if (options.rewindSeconds > 0.0f) {
+        rewind = std::make_unique<RewindBuffer>(size_t(options.rewindSeconds * simulationHz), simulationHz / 2, options.rewindBudget);
+    }
+
+    std::ofstream hashLog;
+    if (options.hashLogPath) {
+        hashLog.open(options.hashLogPath);
+    }
+
+    float step = 1.0f / simulationHz;
+    uint64_t restarts = 0;
+    size_t peakObjects = 0;
+    uint64_t lodSteps[3] = {}; // object-steps spent in each tier
+
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    for (uint64_t i = 0; i < options.ticks; i++) {
+        frameArena().reset();
+
+        // nobody is there to press R
+        if (gameManager.getGameState() == GameState::GAME_OVER) {
+            gameManager.restartGame();
+            restarts++;
+            if (rewind) rewind->clear();
+            held.clear();
+            pressed.clear();
+            levelChanges.assign(1, {0, governor ? governor->getLevel() : 0}); // the clock starts over
+        }
+
+        if (autopilot) {
+            uint64_t tick = gameManager.getClock().tick;
+            if (rewind) held.emplace_back(tick, gameManager.getContext().input);
+            autopilot->drive(gameManager, [&](const SDL_Event& event) {
+                if (rewind) pressed.emplace_back(tick, event);
+                Autopilot::deliver(gameManager, event);
+            });
+        }
+        Uint64 stepStart = SDL_GetPerformanceCounter();
+        window->update(step);
+        gameManager.update(step);
+        if (governor && governor->addSample(float(double(SDL_GetPerformanceCounter() - stepStart) / frequency))) {
+            gameManager.setQuality(governor->getKnobs());
+            levelChanges.emplace_back(gameManager.getClock().tick, governor->getLevel());
+        }
+        peakObjects = std::max(peakObjects, gameManager.getGameObjects().size());
+        for (int tier = 0; tier < 3; tier++) {
+            lodSteps[tier] += gameManager.getLodCount(SimLod(tier));
+        }
+
+        if (hashLog && gameManager.getContext().deterministic) {
+            hashLog << gameManager.getClock().tick << ' ' << std::hex << gameManager.getStateHash() << std::dec << '\n';
+        }
+
+        if (rewind) {
+            gameManager.saveWorld(world);
+            rewind->record(gameManager.getClock().tick, world);
+            while (!held.empty() && held.front().first < rewind->oldestTick()) {
+                held.pop_front();
+            }
+            while (!pressed.empty() && pressed.front().first < rewind->oldestTick()) {
+                pressed.pop_front();
+            }
+        }
+
+        AllocTracker::endFrame();
+    }
+
+    double seconds = double(SDL_GetPerformanceCounter() - start) / frequency;
+    double simSeconds = double(options.ticks) * step;
+
+    std::cout << "headless: " << options.ticks << " ticks in " << seconds << " s" << std::endl;
+    std::cout << "  " << (seconds > 0.0 ? options.ticks / seconds : 0.0) << " ticks/s, "
+              << (seconds > 0.0 ? simSeconds / seconds : 0.0) << "x real time, "
+              << (seconds * 1e6 / std::max<uint64_t>(options.ticks, 1)) << " us/tick" << std::endl;
+    std::cout << "  peak objects " << peakObjects << ", restarts " << restarts << std::endl;
+    uint64_t lodTotal = std::max<uint64_t>(lodSteps[0] + lodSteps[1] + lodSteps[2], 1);
+    std::cout << "  sim lod " << (options.simLod ? "on" : "off") << ": " << 100.0 * lodSteps[0] / lodTotal << "% full, "
+              << 100.0 * lodSteps[1] / lodTotal << "% reduced, " << 100.0 * lodSteps[2] / lodTotal << "% far" << std::endl;
+    std::cout << "  " << jobs.getWorkerCount() << " workers, " << jobs.getBatches() - jobs.getInlineBatches() << " of "
+              << jobs.getBatches() << " entity passes split up, " << jobs.getSteals() << " steals" << std::endl;
+    std::cout << "  ";
+    gameManager.getSpawnDirector().report(std::cout);
+    if (governor) {
+        std::cout << "  ";
+        governor->report(std::cout);
+    }
+    std::cout << "  state hash " << std::hex << gameManager.computeStateHash() << std::dec << std::endl;
+
+    int exitCode = 0;
+    if (rewind && !rewind->empty()) {
+        // go back as far as the history reaches and play it forward again, it has to end up in the same place
+        uint64_t endTick = gameManager.getClock().tick;
+        uint64_t endHash = gameManager.computeStateHash();
+        uint64_t fromTick = rewind->oldestTick();
+
+        Uint64 restoreStart = SDL_GetPerformanceCounter();
+        rewind->restore(fromTick, world);
+        gameManager.loadWorld(world.data(), world.size());
+        double restoreSeconds = double(SDL_GetPerformanceCounter() - restoreStart) / frequency;
+        // recorded again on the way, like after a rewind in the game, so the ring's memory gets checked too
+        rewind->truncateAfter(fromTick);
+
+        auto heldThen = std::find_if(held.begin(), held.end(), [fromTick](const auto& entry) { return entry.first == fromTick; });
+        if (heldThen != held.end()) {
+            gameManager.getContext().input = heldThen->second;
+        }
+        auto next = std::find_if(pressed.begin(), pressed.end(), [fromTick](const auto& entry) { return entry.first >= fromTick; });
+        // the last change at or before fromTick, then the rest as they come up
+        auto levelAt = std::upper_bound(levelChanges.begin(), levelChanges.end(), std::make_pair(fromTick, QualityGovernor::levelCount));
+        gameManager.setQuality(QualityGovernor::levels[std::prev(levelAt)->second]);
+        while (gameManager.getClock().tick < endTick && gameManager.getGameState() != GameState::GAME_OVER) {
+            for (; next != pressed.end() && next->first == gameManager.getClock().tick; ++next) {
+                Autopilot::deliver(gameManager, next->second);
+            }
+            for (; levelAt != levelChanges.end() && levelAt->first == gameManager.getClock().tick; ++levelAt) {
+                gameManager.setQuality(QualityGovernor::levels[levelAt->second]);
+            }
+            window->update(step);
+            gameManager.update(step);
+            gameManager.saveWorld(world);
+            rewind->record(gameManager.getClock().tick, world);
+        }
+        bool match = gameManager.computeStateHash() == endHash;
+        // nothing dropped by the truncate may still count towards the budget
+        bool memoryMatch = rewind->getMemoryUsed() == rewind->countLiveMemory();
+
+        rewind->report(std::cout);
+        std::cout << "  restored tick " << fromTick << " in " << restoreSeconds * 1e6 << " us, replayed to "
+                  << gameManager.getClock().tick << ": " << (match ? "identical" : "MISMATCH") << std::endl;
+        if (!memoryMatch) {
+            std::cout << "  rewind memory MISMATCH: " << rewind->getMemoryUsed() << " B counted, "
+                      << rewind->countLiveMemory() << " B in live frames" << std::endl;
+        }
+        if (!match || !memoryMatch) exitCode = 1;
+    }
+
+    delete window;
+    return exitCode;
+}
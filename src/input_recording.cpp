@@ -0,0 +1,192 @@
+#include "../include/input_recording.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char magic[4] = {'G', 'R', 'I', 'N'};
+const uint16_t formatVersion = 2;
+
+enum EventKind : uint8_t {
+    KeyDown = 0,
+    KeyUp = 1,
+    MouseDown = 2,
+    MouseUp = 3,
+    EndOfRecording = 0xff
+};
+
+void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+uint64_t zigzag(int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+int64_t unzigzag(uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+template <typename T>
+void writeRaw(std::vector<uint8_t>& out, const T& value) {
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+struct Cursor {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool failed = false;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        int shift = 0;
+        while (true) {
+            if (p >= end || shift > 63) { failed = true; return 0; }
+            uint8_t byte = *p++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+            shift += 7;
+        }
+    }
+
+    template <typename T>
+    T raw() {
+        T value{};
+        if (end - p < ptrdiff_t(sizeof(T))) { failed = true; p = end; return value; }
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+};
+
+} // namespace
+
+bool InputRecorder::open(const std::string& path, const RecordingHeader& header) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Could not open recording " << path << std::endl;
+        return false;
+    }
+
+    buffer.clear();
+    buffer.insert(buffer.end(), magic, magic + 4);
+    writeRaw(buffer, formatVersion);
+    writeRaw(buffer, header.seed);
+    writeRaw(buffer, header.simulationHz);
+    writeRaw(buffer, header.displayWidth);
+    writeRaw(buffer, header.displayHeight);
+    writeRaw(buffer, header.rewindSeconds);
+    writeRaw(buffer, header.rewindBudget);
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    lastStep = 0;
+    eventCount = 0;
+    return true;
+}
+
+void InputRecorder::record(uint64_t step, const SDL_Event& event) {
+    if (!out) return;
+
+    uint8_t kind;
+    switch (event.type) {
+        case SDL_KEYDOWN: kind = KeyDown; break;
+        case SDL_KEYUP: kind = KeyUp; break;
+        case SDL_MOUSEBUTTONDOWN: kind = MouseDown; break;
+        case SDL_MOUSEBUTTONUP: kind = MouseUp; break;
+        default: return; // nothing in the sim looks at anything else
+    }
+
+    buffer.clear();
+    writeVarint(buffer, step - lastStep);
+    buffer.push_back(kind);
+    if (kind == KeyDown || kind == KeyUp) {
+        writeVarint(buffer, uint32_t(event.key.keysym.sym));
+    } else {
+        buffer.push_back(event.button.button);
+        writeVarint(buffer, zigzag(event.button.x));
+        writeVarint(buffer, zigzag(event.button.y));
+    }
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    lastStep = step;
+    eventCount++;
+}
+
+void InputRecorder::finish(uint64_t step, uint64_t stateHash) {
+    if (!out) return;
+
+    buffer.clear();
+    writeVarint(buffer, step - lastStep);
+    buffer.push_back(EndOfRecording);
+    writeRaw(buffer, stateHash);
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    out.close();
+}
+
+bool InputReplay::open(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Could not open recording " << path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    Cursor cursor{data.data(), data.data() + data.size()};
+    char fileMagic[4] = {};
+    for (char& c : fileMagic) c = char(cursor.raw<uint8_t>());
+    uint16_t version = cursor.raw<uint16_t>();
+    if (cursor.failed || std::memcmp(fileMagic, magic, 4) != 0 || version != formatVersion) {
+        std::cerr << path << " is not a recording this build understands" << std::endl;
+        return false;
+    }
+    header.seed = cursor.raw<uint64_t>();
+    header.simulationHz = cursor.raw<uint32_t>();
+    header.displayWidth = cursor.raw<int32_t>();
+    header.displayHeight = cursor.raw<int32_t>();
+    header.rewindSeconds = cursor.raw<float>();
+    header.rewindBudget = cursor.raw<uint64_t>();
+
+    events.clear();
+    next = 0;
+    hasFooter = false;
+    uint64_t step = 0;
+    while (cursor.p < cursor.end && !cursor.failed) {
+        step += cursor.varint();
+        uint8_t kind = cursor.raw<uint8_t>();
+
+        if (kind == EndOfRecording) {
+            finalHash = cursor.raw<uint64_t>();
+            hasFooter = !cursor.failed;
+            break;
+        }
+
+        RecordedEvent recorded;
+        recorded.step = step;
+        std::memset(&recorded.event, 0, sizeof(SDL_Event));
+        switch (kind) {
+            case KeyDown:
+            case KeyUp:
+                recorded.event.type = kind == KeyDown ? SDL_KEYDOWN : SDL_KEYUP;
+                recorded.event.key.keysym.sym = SDL_Keycode(cursor.varint());
+                break;
+            case MouseDown:
+            case MouseUp:
+                recorded.event.type = kind == MouseDown ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+                recorded.event.button.button = cursor.raw<uint8_t>();
+                recorded.event.button.x = int(unzigzag(cursor.varint()));
+                recorded.event.button.y = int(unzigzag(cursor.varint()));
+                break;
+            default:
+                cursor.failed = true;
+                break;
+        }
+        if (cursor.failed) break;
+        events.push_back(recorded);
+    }
+    // a crashed recording still replays up to where it stopped, there's just nothing to check against
+    endStep = step;
+
+    if (cursor.failed) {
+        std::cerr << "Recording " << path << " is damaged, replaying the first " << events.size() << " events" << std::endl;
+    }
+    return true;
+}
@@ -0,0 +1,142 @@
+#include "../include/job_system.h"
+#include "../include/frame_arena.h"
+#include <algorithm>
+
+namespace {
+thread_local unsigned currentSlotIndex = 0;
+}
+
+JobSystem::JobSystem(unsigned workerCount) {
+    for (unsigned i = 0; i <= workerCount; i++) {
+        deques.push_back(std::make_unique<Deque>());
+    }
+    for (unsigned i = 1; i <= workerCount; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned JobSystem::defaultWorkerCount() {
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 2 ? cores - 2 : 0;
+}
+
+unsigned JobSystem::currentSlot() {
+    return currentSlotIndex;
+}
+
+bool JobSystem::push(unsigned slot, Job job) {
+    Deque& deque = *deques[slot];
+    std::lock_guard<std::mutex> lock(deque.mutex);
+    if (deque.tail - deque.head >= dequeCapacity) return false;
+    deque.jobs[deque.tail % dequeCapacity] = job;
+    deque.tail++;
+    return true;
+}
+
+bool JobSystem::pop(unsigned slot, Job& out) {
+    Deque& deque = *deques[slot];
+    std::lock_guard<std::mutex> lock(deque.mutex);
+    if (deque.head == deque.tail) return false;
+    deque.tail--;
+    out = deque.jobs[deque.tail % dequeCapacity];
+    return true;
+}
+
+bool JobSystem::steal(unsigned thief, Job& out) {
+    unsigned slots = getSlotCount();
+    // start at the neighbour so thieves don't all pile onto slot 0
+    for (unsigned i = 1; i < slots; i++) {
+        Deque& deque = *deques[(thief + i) % slots];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        if (deque.head == deque.tail) continue;
+        out = deque.jobs[deque.head % dequeCapacity];
+        deque.head++;
+        steals.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::findWork(unsigned slot, Job& out) {
+    return pop(slot, out) || steal(slot, out);
+}
+
+void JobSystem::execute(unsigned slot, Job job) {
+    // keep the front half, push the back half where a thief can take it
+    while (job.end - job.begin > batchGrain) {
+        size_t mid = job.begin + (job.end - job.begin) / 2;
+        if (!push(slot, Job{mid, job.end})) break; // deque full, just do the lot
+        job.end = mid;
+    }
+    batchFn(batchData, job.begin, job.end);
+    pendingItems.fetch_sub(job.end - job.begin, std::memory_order_acq_rel);
+}
+
+void JobSystem::workerLoop(unsigned slot) {
+    currentSlotIndex = slot;
+    uint64_t seenEpoch = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [&] { return stopping || batchEpoch != seenEpoch; });
+            if (stopping) return;
+            seenEpoch = batchEpoch;
+        }
+        // nothing from an earlier batch is still in use
+        frameArena().reset();
+
+        // help until the whole batch is done, a range can turn up in any deque until then
+        Job job;
+        while (pendingItems.load(std::memory_order_acquire) > 0) {
+            if (findWork(slot, job)) {
+                execute(slot, job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+void JobSystem::run(size_t count, size_t grain, RangeFn fn, void* data) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    batches++;
+
+    // waking everyone up costs more than a single range of work
+    if (workers.empty() || count <= grain) {
+        inlineBatches++;
+        fn(data, 0, count);
+        return;
+    }
+
+    batchFn = fn;
+    batchData = data;
+    batchGrain = grain;
+    pendingItems.store(count, std::memory_order_release);
+    push(0, Job{0, count});
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        batchEpoch++;
+    }
+    wake.notify_all();
+
+    Job job;
+    while (pendingItems.load(std::memory_order_acquire) > 0) {
+        if (findWork(0, job)) {
+            execute(0, job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
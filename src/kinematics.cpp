@@ -0,0 +1,113 @@
+#include "../include/kinematics.h"
+#include "../include/entities.h"
+#include "../include/job_system.h"
+#include <algorithm>
+#include <cfloat>
+
+Kinematics::Kinematics() {
+    // the old per-step knockback decay, the player's a bit floaty on purpose
+    profiles[size_t(DecayProfile::Knockback)] = DecaySettings{1.0f, 0.1f};
+}
+
+void Kinematics::reset(size_t count) {
+    // assign/resize keep their capacity, so after the first few steps none of this allocates
+    objects.assign(count, nullptr);
+    dt.assign(count, 0.0f);
+    for (std::vector<float>* array : {&px, &py, &angle, &vx, &vy, &spin, &ix, &iy, &dx, &dy,
+                                      &damping, &cutoffSquared, &bx, &by, &burstTime, &minX, &minY, &maxX, &maxY}) {
+        array->resize(count);
+    }
+}
+
+void Kinematics::load(size_t slot, GameObject& object, float step) {
+    const Motion& motion = object.motion;
+    const DecaySettings& profile = profiles[size_t(motion.profile)];
+
+    objects[slot] = &object;
+    dt[slot] = step;
+    px[slot] = object.position.x;
+    py[slot] = object.position.y;
+    angle[slot] = object.angle;
+    vx[slot] = motion.velocity.x;
+    vy[slot] = motion.velocity.y;
+    spin[slot] = motion.spin;
+    ix[slot] = motion.impulse.x;
+    iy[slot] = motion.impulse.y;
+    dx[slot] = motion.drift.x;
+    dy[slot] = motion.drift.y;
+    // per object here so the loop itself is all multiplies and adds
+    damping[slot] = std::max(0.0f, 1.0f - profile.rate * step);
+    cutoffSquared[slot] = profile.cutoff * profile.cutoff;
+    bx[slot] = motion.burst.x;
+    by[slot] = motion.burst.y;
+    burstTime[slot] = motion.burstTime;
+    minX[slot] = motion.clamped ? motion.clampMin.x : -FLT_MAX;
+    minY[slot] = motion.clamped ? motion.clampMin.y : -FLT_MAX;
+    maxX[slot] = motion.clamped ? motion.clampMax.x : FLT_MAX;
+    maxY[slot] = motion.clamped ? motion.clampMax.y : FLT_MAX;
+}
+
+void Kinematics::integrate(size_t begin, size_t end) {
+    // a few short loops rather than one long one: gcc won't vectorize a loop over this many arrays
+    // (too many runtime overlap checks), split up each one stays under its limit
+    // no branches in any of them, slots that didn't step have dt 0 and go through unchanged (and aren't stored anyway)
+
+    // semi-implicit, the new drift is what moves things this step
+    for (size_t i = begin; i < end; i++) {
+        float newX = (dx[i] + ix[i]) * damping[i];
+        float newY = (dy[i] + iy[i]) * damping[i];
+        // selects, not a multiply by 0/1, gcc only if-converts these
+        bool keep = newX * newX + newY * newY >= cutoffSquared[i];
+        dx[i] = keep ? newX : 0.0f;
+        dy[i] = keep ? newY : 0.0f;
+    }
+
+    // std::min on the elements themselves picks between two addresses, which doesn't vectorize, hence the copies
+    for (size_t i = begin; i < end; i++) {
+        float time = dt[i], left = burstTime[i];
+        px[i] = std::min(std::max(px[i] + ((vx[i] + dx[i]) * time + bx[i] * std::min(left, time)), minX[i]), maxX[i]);
+    }
+    for (size_t i = begin; i < end; i++) {
+        float time = dt[i], left = burstTime[i];
+        py[i] = std::min(std::max(py[i] + ((vy[i] + dy[i]) * time + by[i] * std::min(left, time)), minY[i]), maxY[i]);
+    }
+    for (size_t i = begin; i < end; i++) {
+        float time = dt[i], left = burstTime[i];
+        burstTime[i] = left - std::min(left, time);
+        angle[i] += spin[i] * time;
+    }
+}
+
+void Kinematics::store(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        GameObject* object = objects[i];
+        if (!object) continue;
+
+        bool moved = px[i] != object->position.x || py[i] != object->position.y || angle[i] != object->angle;
+        object->position = Vector2D(px[i], py[i]);
+        object->angle = angle[i];
+
+        Motion& motion = object->motion;
+        motion.velocity = Vector2D(0, 0);
+        motion.spin = 0.0f;
+        motion.impulse = Vector2D(0, 0);
+        motion.drift = Vector2D(dx[i], dy[i]);
+        motion.burstTime = burstTime[i];
+        if (motion.burstTime <= 0.0f) motion.burst = Vector2D(0, 0);
+
+        // the one transform this object gets this step
+        if (moved) object->updateCollisionVertices();
+    }
+}
+
+void Kinematics::run(JobSystem* jobs, size_t grain) {
+    auto range = [this](size_t begin, size_t end) {
+        integrate(begin, end);
+        store(begin, end);
+    };
+    if (jobs) {
+        jobs->parallelFor(objects.size(), grain, range);
+    } else {
+        range(0, objects.size());
+    }
+}
@@ -2,26 +2,13 @@
 #include "../include/utils.h"
 #include "../include/player.h"
 #include "../include/window.h"
+#include "../include/render_snapshot.h"
+#include "../include/state_stream.h"
 #include <iostream>
 #include <algorithm>
 
 void Pentagon::initPentagonCollision() {
-    vertices.clear();
-    localVertices.clear();
-
-    // Define vertices in clockwise order around the perimeter
-    // Top vertex
-    localVertices.push_back(Vector2D(0, -dimensions.y / 2.0f)); 
-    // Top right vertex
-    localVertices.push_back(Vector2D(dimensions.x / 2.0f, -dimensions.y / 6.0f)); 
-    // Bottom right vertex
-    localVertices.push_back(Vector2D(dimensions.x / 2.0f - 18.0f, dimensions.y / 2.0f - 4.0f)); 
-    // Bottom left vertex
-    localVertices.push_back(Vector2D(-dimensions.x / 2.0f + 18.0f, dimensions.y / 2.0f - 4.0f)); 
-    // Top left vertex
-    localVertices.push_back(Vector2D(-dimensions.x / 2.0f, -dimensions.y / 6.0f)); 
-
-    updateCollisionVertices();
+    setShape(ShapeKind::Pentagon);
 }
 
 Pentagon::Pentagon(
@@ -39,9 +26,7 @@ Pentagon::Pentagon(
     maxHealth(health),
     score(50.0f)
 {
-    texture = TextureManager::getTexture(fetchResourcePath("pentagon.png"), window->renderer);
-    // random angle at init
-    angle = (rand() % 360) * M_PI / 180.0f;
+    texture = window->textures.getTexture(fetchResourcePath("pentagon.png"), window->renderer);
     initPentagonCollision();
 }
 
@@ -51,131 +36,79 @@ Pentagon::~Pentagon() {
     }
 }
 
-void Pentagon::draw(SDL_Renderer* renderer) {
-    if (!isActive) return;
+bool Pentagon::writeSnapshot(RenderEntity& out) const {
+    if (!isActive) return false;
     SDL_Rect windowBounds = window->getBounds();
     if (!isInWindow(windowBounds)) {
-        return;
+        return false;
     }
 
-    Vector2D p = getPosition();
-    Vector2D d = getDimensions();
-    SDL_Rect rect = {
-        int(p.x - window->x - d.x/2),
-        int(p.y - window->y - d.y/2),
-        int(d.x),
-        int(d.y)
-    };
-
-    // Apply tinting effect
-    float currentTime = SDL_GetTicks() / 1000.0f;
-    if (currentTime - lastHitTime < whiteFlashDuration) {
-        SDL_SetTextureColorMod(texture, 255, 255, 255); // White flash when hit
-    } else {
-        SDL_SetTextureColorMod(texture, color[0], color[1], color[2]); // Cyan color
+    // the white flash is mixed in here, the color itself never changes
+    GameObject::writeSnapshot(out);
+    if (flashAmount > 0.0f) {
+        for (int i = 0; i < 3; i++) {
+            out.color[i] = Uint8(out.color[i] + (255 - out.color[i]) * flashAmount);
+        }
     }
-
-    SDL_Point center = {rect.w/2, rect.h/2};
-    float angleDeg = angle * 180.0f / M_PI;
-    SDL_RenderCopyEx(
-        renderer, 
-        texture, 
-        nullptr, 
-        &rect, 
-        angleDeg, 
-        &center, 
-        SDL_FLIP_NONE
-    );
-
-    // uncomment if debug
-    // drawCollisionVertices(renderer);
-    drawHealthBar(renderer);
+    out.healthRatio = health / maxHealth;
+    return true;
 }
 
-void Pentagon::update(float deltaTime) {
+void Pentagon::update(const FrameClock&) {
     if (!isActive) return;
     if (getHealth() <= 0) {
         setActive(false);
         return;
     }
 
+    // nothing but looks in here, skipped out of sight (see sim_lod.h)
+    if (lod != SimLod::Full || !context->cosmetics) return;
+
     // rotate very slowly
     float angleRotate = 10.0f;
-    float dAngle = angleRotate * M_PI / 180.0f * deltaTime;
-    rotate(dAngle);
-
-    // Reset color after white flash
-    float currentTime = SDL_GetTicks() / 1000.0f;
-    if (currentTime - lastHitTime < whiteFlashDuration) {
-        setColor(255, 255, 255, 255); // White flash
-    } else {
-        setColor(0, 255, 255, 255); // Reset to cyan
-    }
-
+    motion.spin = angleRotate * M_PI / 180.0f;
 }
 
-void Pentagon::drawCollisionVertices(SDL_Renderer* renderer) const {
-    if (!isActive) return;
-
-    // Draw vertices for debugging purposes
-    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-    for (size_t i = 0; i < vertices.size(); i++) {
-        const Vector2D& v1 = vertices[i];
-        const Vector2D& v2 = vertices[(i + 1) % vertices.size()];
-        SDL_RenderDrawLine(
-            renderer,
-            int(v1.x - window->x), int(v1.y - window->y),
-            int(v2.x - window->x), int(v2.y - window->y)
-        );
-    }
-    // Draw center point
-    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-    SDL_RenderDrawPoint(renderer, int(position.x - window->x), int(position.y - window->y));
+void Pentagon::saveState(StateWriter& out) const {
+    GameObject::saveState(out);
+    out.write(health);
+    out.write(maxHealth);
+    out.write(score);
+    out.write(flashStartTick);
+    out.write(flashAmount);
 }
 
-void Pentagon::drawHealthBar(SDL_Renderer* renderer) const {
-    if (!isActive) return;
-    SDL_Rect windowBounds = window->getBounds();
-
-    Vector2D pos = getPosition(); 
-    Vector2D dim = getDimensions();
+void Pentagon::loadState(StateReader& in) {
+    GameObject::loadState(in);
+    in.read(health);
+    in.read(maxHealth);
+    in.read(score);
+    in.read(flashStartTick);
+    in.read(flashAmount);
+}
 
-    // Position health bar above the pentagon
-    SDL_Rect healthBarRect = {
-        int(pos.x - windowBounds.x - dim.x / 2),
-        int(pos.y - windowBounds.y - dim.y / 2) - 10,
-        int(dim.x),
-        5
-    };
+void Pentagon::changeHealthBy(float delta) {
+    health = std::clamp(health + delta, 0.0f, maxHealth);
+    // the flash is started by whoever dealt the damage (flash()), they know what time it is
+}
 
-    // draw health container
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_RenderFillRect(renderer, &healthBarRect);
+void Pentagon::flash(const FrameClock& clock) {
+    // only for looks: not below full rate (see sim_lod.h) or when the quality governor needs the time
+    if (lod != SimLod::Full || !context->cosmetics) return;
+    // hit again while still white, starts over
+    context->tweens.cancel(flashTween);
+    flashStartTick = clock.tick;
+    scheduleTimers();
+}
 
-    // draw health ba
-    float healthRatio = health / maxHealth;
-    SDL_Rect currentHealthBarRect = {
-        healthBarRect.x,
-        healthBarRect.y,
-        int(healthBarRect.w * healthRatio),
-        healthBarRect.h
-    };
-    
-    // color transition based on health
-    if (healthRatio > 0.5f) {
-        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // Green
-    } else if (healthRatio > 0.25f) {
-        SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255); // Yellow
-    } else {
-        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // Red
+void Pentagon::scheduleTimers() {
+    // white straight away, back to cyan over whiteFlashDuration
+    uint64_t duration = SimContext::ticksFor(whiteFlashDuration);
+    if (flashStartTick != 0 && flashStartTick + duration > context->tweens.getTick()) {
+        flashTween = context->tweens.start(&flashAmount, 1.0f, 0.0f, flashStartTick, duration, Easing::OutQuad);
     }
-    SDL_RenderFillRect(renderer, &currentHealthBarRect);
 }
 
-void Pentagon::changeHealthBy(float delta) {
-    health = std::clamp(health + delta, 0.0f, maxHealth);
-    
-    if (delta < 0) {
-        lastHitTime = SDL_GetTicks() / 1000.0f;
-    }
+void Pentagon::cancelTimers() {
+    if (context) context->tweens.cancel(flashTween);
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "../include/utils.h"
 #include "../include/window.h"
 #include "../include/entities.h"
+#include "../include/render_snapshot.h"
+#include "../include/state_stream.h"
 #include <SDL.h>
 #include <iostream>
 #include <map>
@@ -21,13 +23,12 @@ Player::Player(const Vector2D& pos,
         speed
     ),
     window(window),
-    texture(TextureManager::getTexture(fetchResourcePath(texturePath), window->renderer)),
+    texture(window->textures.getTexture(fetchResourcePath(texturePath), window->renderer)),
     gameManager(nullptr),
-    knockbackVelocity(Vector2D(0, 0)),
-    knockbackDecay(1.0f),
     lastShot(0)
 {
-    if (!texture) {
+    motion.profile = DecayProfile::Knockback;
+    if (!texture && window->renderer) { // headless has no textures at all, that's fine
         std::cerr << "Failed to load player texture: " << IMG_GetError() << '\n';
         return;
     }
@@ -40,172 +41,79 @@ void Player::setSpeed(float s) {
     GameObject::speed = s;
 }
 
-void Player::draw(SDL_Renderer* renderer) {
-    Vector2D p = getPosition();
-    Vector2D d = getDimensions();
-    SDL_Rect rect = {
-        int(p.x - window->x - d.x/2),
-        int(p.y - window->y - d.y/2),
-        int(d.x),
-        int(d.y)
-    };
-    
-    // draw death animation
-    if (isDying) {
-        SDL_SetTextureColorMod(texture, color[0], color[1], color[2]);
-        SDL_SetTextureAlphaMod(texture, color[3]);
-        
-        float angleDeg = angle * 180.0f / M_PI;
-        SDL_Point center = {rect.w/2, rect.h/2};
-        
-        SDL_RenderCopyEx(
-            renderer,
-            texture,
-            nullptr,
-            &rect,
-            angleDeg,
-            &center,
-            SDL_FLIP_NONE
-        );
-    } else {
-        SDL_RenderCopy(renderer, texture, nullptr, &rect);
-    }
-    
-    // Get the window dimensions to position the text
-    int windowWidth, windowHeight;
-    SDL_GetRendererOutputSize(renderer, &windowWidth, &windowHeight);
-    
-    int fontSize = 16;
-    
-    // Draw health text at the bottom right of the screen
-    std::string healthText = std::to_string(health) + "/" + std::to_string(maxHealth) + " HP";
-    
-    // Position text at bottom right with some padding
-    int textX = windowWidth - (healthText.length() * (fontSize/2 + 1)) - 10;
-    int textY = windowHeight - fontSize - 10;
-    
-    // Draw health text
-    SDL_Color healthColor = {255, 255, 255, 255}; // White by default
-    
-    // Change color based on health percentage
-    float healthPercent = float(health) / float(maxHealth);
-    if (healthPercent <= 0.25f) {
-        // Red for low health (25% or below)
-        healthColor = {255, 0, 0, 255};
-    } else if (healthPercent <= 0.5f) {
-        // Yellow for medium health (50% or below)
-        healthColor = {255, 255, 0, 255};
+bool Player::writeSnapshot(RenderEntity& out) const {
+    GameObject::writeSnapshot(out);
+    out.texture = texture;
+
+    // only tinted while dying, blinking between red and a faded out white
+    if (!isDying) {
+        out.color[0] = out.color[1] = out.color[2] = out.color[3] = 255;
     } else {
-        // Green for good health (above 50%)
-        healthColor = {0, 255, 0, 255};
+        out.color[0] = 255;
+        out.color[1] = out.color[2] = Uint8(255 * (1.0f - deathFlash));
+        out.color[3] = Uint8(100 + 155 * deathFlash);
     }
-    
-    renderText(renderer, healthText, textX, textY, fontSize, healthColor);
-    
-    // Draw score text at the top left of the screen
-    std::string scoreText = "Score: " + std::to_string(score);
-    int scoreTextX = 10;
-    int scoreTextY = 10;
-    SDL_Color scoreColor = {255, 255, 255, 255}; // White color for score
-    
-    renderText(renderer, scoreText, scoreTextX, scoreTextY, fontSize, scoreColor);
-    
-    // uncomment if debug
-    // drawCollisionVertices(renderer);
+    return texture != nullptr;
 }
 
-void Player::update(float deltaTime) {
-    // Check if player is in death animation
-    if (isDying) {
-        updateDeathAnimation(deltaTime);
-        return; // Skip normal update when dying
-    }
-    
-    // Handle rapid knockback phase first (60% of knockback - fast but brief)
-    if (rapidKnockbackTimer > 0) {
-        // Apply rapid movement
-        Vector2D rapidVel = rapidKnockbackVelocity * deltaTime;
-        GameObject::move(rapidVel);
-        
-        // Decrement timer
-        rapidKnockbackTimer -= deltaTime;
-        
-        // Transfer any remaining velocity to the regular knockback when time is up
-        if (rapidKnockbackTimer <= 0) {
-            // Add any remaining rapid velocity to regular knockback for smooth transition
-            if (rapidKnockbackTimer < 0) {
-                float remainingTimeFraction = -rapidKnockbackTimer / rapidKnockbackDuration;
-                knockbackVelocity += rapidKnockbackVelocity * remainingTimeFraction;
-            }
-            rapidKnockbackVelocity = Vector2D(0, 0);
-        }
-    }
-    
-    // Handle regular knockback phase
-    if (knockbackVelocity.x != 0 || knockbackVelocity.y != 0) {
-        Vector2D vel = knockbackVelocity * deltaTime;
-        GameObject::move(vel);
-        
-        // decay
-        float f = std::max(0.0f, 1.0f - knockbackDecay * deltaTime);
-        knockbackVelocity *= f;
-        
-        // reset when below minimum threshold
-        if (knockbackVelocity.lengthSquared() < knockbackMinThreshold * knockbackMinThreshold) {
-            knockbackVelocity = Vector2D(0, 0);
-        }
-    }
-    
-    std::map<std::string, bool> keyStates = getKeyState();
-    SDL_Rect bounds = window->getBounds();
-    updateMovement(keyStates, bounds, deltaTime);
+void Player::saveState(StateWriter& out) const {
+    GameObject::saveState(out);
+    out.write(health);
+    out.write(maxHealth);
+    out.write(score);
+    out.write(lastHitTime);
+    out.write(isDying);
+    out.write(deathStartTick);
+    out.write(deathFlash);
+    out.write(aliveDimensions);
+}
 
-    // shooting
-    if (isDying || !isActive) {
+void Player::loadState(StateReader& in) {
+    GameObject::loadState(in);
+    in.read(health);
+    in.read(maxHealth);
+    in.read(score);
+    in.read(lastHitTime);
+    in.read(isDying);
+    in.read(deathStartTick);
+    in.read(deathFlash);
+    in.read(aliveDimensions);
+}
+
+void Player::update(const FrameClock&) {
+    // the death animation is a script (see runDeath()), nothing else moves while it plays
+    if (isDying) {
+        motion.stop();
         return;
     }
-    int mouseX, mouseY;
-    Uint32 m = SDL_GetMouseState(&mouseX, &mouseY);
-    std::map<std::string, bool> mouseState = {
-        {"left", m & SDL_BUTTON(SDL_BUTTON_LEFT)},
-        {"right", m & SDL_BUTTON(SDL_BUTTON_RIGHT)}
-    };
-    
-    initCircleCollision();
+
+    // this game's input, shooting is event driven (processEvent) so the mouse state isn't needed here
+    // knockback carries on by itself in the integrator, on top of this
+    SDL_Rect bounds = window->getBounds();
+    updateMovement(context->input, bounds);
 }
 
-void Player::updateMovement(const std::map<std::string,bool>& keyStates, const SDL_Rect& bounds, float deltaTime) {
+void Player::updateMovement(const InputState& input, const SDL_Rect& bounds) {
     Vector2D delta(0, 0);
-    if (keyStates.at("up")) delta.y -= 1;
-    if (keyStates.at("down")) delta.y += 1;
-    if (keyStates.at("left")) delta.x -= 1;
-    if (keyStates.at("right")) delta.x += 1;
+    if (input.up) delta.y -= 1;
+    if (input.down) delta.y += 1;
+    if (input.left) delta.x -= 1;
+    if (input.right) delta.x += 1;
 
     if (delta.x && delta.y) delta *= 0.7071f; // diagonal
-    Vector2D vel = delta * speed * deltaTime;
-    GameObject::move(vel);
+    motion.velocity = delta * speed;
 
-    // clamp
-    Vector2D pos = getPosition();
+    // clamp, after the knockback's been added in too
     float halfWidth = getDimensions().x / 2.0f;
     float halfHeight = getDimensions().y / 2.0f;
-
-    pos.x = std::clamp(pos.x, 
-                       float(bounds.x) + halfWidth, 
-                       float(bounds.x + bounds.w) - halfWidth
-                      );
-
-    pos.y = std::clamp(pos.y, 
-                       float(bounds.y) + halfHeight, 
-                       float(bounds.y + bounds.h) - halfHeight
-                      );
-    
-    GameObject::setPosition(pos);
+    motion.clamped = true;
+    motion.clampMin = Vector2D(float(bounds.x) + halfWidth, float(bounds.y) + halfHeight);
+    motion.clampMax = Vector2D(float(bounds.x + bounds.w) - halfWidth, float(bounds.y + bounds.h) - halfHeight);
 }
 
-void Player::changeHealthBy(int delta) {
-    int current = SDL_GetTicks();
-    if (current - lastHitTime < static_cast<int>(gracePeriod * 1000)) return; // ignore hits during grace period
+void Player::changeHealthBy(int delta, float now) {
+    float current = now;
+    if (lastHitTime >= 0.0f && current - lastHitTime < gracePeriod) return; // ignore hits during grace period
     
     // Record the hit time for grace period
     lastHitTime = current;
@@ -222,46 +130,62 @@ void Player::changeHealthBy(int delta) {
 void Player::startDeathSequence() {
     std::cerr << "Player death sequence started" << std::endl;
     isDying = true;
-    deathTimer = 0.0f;
-    // let the death animation play out
+    deathStartTick = 0; // set by runDeath() when it picks this up
+    // let the death animation play out, starting next step
+    died.signal();
 }
 
-void Player::reinitializeCollision() {
-    std::cerr << "Reinitializing collision for player at position: " << position.x << ", " << position.y << std::endl;
-    vertices.clear();
-    initCircleCollision();
+void Player::scheduleTimers() {
+    if (!context) return;
+    context->scripts.stop(deathScript);
+    deathScript = context->scripts.start(runDeath());
 }
 
-void Player::updateDeathAnimation(float deltaTime) {
-    if (!isDying) return;
-    
-    deathTimer += deltaTime;
-    
-    // During death animation, flash the player and rotate
-    float flashRate = 10.0f; // flashes per second
-    bool flashVisible = (static_cast<int>(deathTimer * flashRate) % 2 == 0);
-    
-    if (flashVisible) {
-        setColor(255, 0, 0, 255); // Red flash
-    } else {
-        setColor(255, 255, 255, 100); // Fade out
-    }
+void Player::cancelTimers() {
+    if (!context) return;
+    context->scripts.stop(deathScript);
+    cancelDeathTweens();
+}
 
-    // Shrink the player
-    float shrinkFactor = 1.0f - (deathTimer / deathAnimationDuration);
-    Vector2D originalDimensions(getDimensions().x, getDimensions().y);
-    setDimensions(originalDimensions * std::max(0.1f, shrinkFactor));
-    
-    // When animation completes, actually set to inactive
-    if (deathTimer >= deathAnimationDuration) {
-        std::cerr << "Player death animation complete, setting inactive" << std::endl;
-        isActive = false;
-        
-        // Trigger game over state
-        if (gameManager) {
-            gameManager->triggerGameOver();
-        }
+void Player::cancelDeathTweens() {
+    context->tweens.cancel(shrinkXTween);
+    context->tweens.cancel(shrinkYTween);
+    context->tweens.cancel(deathFlashTween);
+}
+
+// sits on the died event for the whole game, so a live player costs the scheduler nothing
+// the animation itself is tweens, all this does is start them and wait for the end
+ScriptTask Player::runDeath() {
+    if (!isDying) {
+        co_await died;
+    }
+    if (deathStartTick == 0) {
+        deathStartTick = context->scripts.now();
+        aliveDimensions = dimensions;
     }
+
+    // shrink to a tenth, blinking the whole way. the hull isn't updated for the new size, it doesn't need to be,
+    // nothing collides with a dying player
+    Tweens& tweens = context->tweens;
+    uint64_t duration = SimContext::ticksFor(deathAnimationDuration);
+    cancelDeathTweens(); // a restored player may already have them
+    shrinkXTween = tweens.start(&dimensions.x, aliveDimensions.x, aliveDimensions.x * 0.1f, deathStartTick, duration);
+    shrinkYTween = tweens.start(&dimensions.y, aliveDimensions.y, aliveDimensions.y * 0.1f, deathStartTick, duration);
+    deathFlashTween = tweens.start(&deathFlash, 1.0f, 0.0f, deathStartTick, SimContext::ticksFor(deathFlashPeriod),
+                                   Easing::Step, TweenMode::Loop);
+
+    co_await waitUntil(deathStartTick + duration);
+    tweens.cancel(deathFlashTween);
+    std::cerr << "Player death animation complete, setting inactive" << std::endl;
+    isActive = false;
+    // Trigger game over state, once the whole update pass is done
+    context->effects().requestGameOver();
+}
+
+void Player::reinitializeCollision() {
+    std::cerr << "Reinitializing collision for player at position: " << position.x << ", " << position.y << std::endl;
+    vertices.clear();
+    initCircleCollision();
 }
 
 void Player::processEvent(const SDL_Event& event) {
@@ -305,30 +229,8 @@ void Player::applyKnockback(const Vector2D& impulse) {
     GameObject::move(immediateMove);
     
     // phase 2
-    rapidKnockbackVelocity = impulse * phaseTwoMultiplier;
-    rapidKnockbackTimer = rapidKnockbackDuration;
+    motion.kick(impulse * phaseTwoMultiplier, rapidKnockbackDuration);
     
     // phase 3
-    knockbackVelocity = impulse * phaseThreeMultiplier;
+    motion.push(impulse * phaseThreeMultiplier);
 }
-
-void Player::drawCollisionVertices(SDL_Renderer* renderer) const {
-    if (!isActive) return;
-
-    SDL_Rect windowBounds = window->getBounds();
-
-    // draw vertices at runtime
-    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-    for (size_t i = 0; i < vertices.size(); i++) {
-        const Vector2D& v1 = vertices[i];
-        const Vector2D& v2 = vertices[(i + 1) % vertices.size()];
-        SDL_RenderDrawLine(
-            renderer,
-            int(v1.x - window->x), int(v1.y - window->y),
-            int(v2.x - window->x), int(v2.y - window->y)
-        );
-    }
-    // draw center
-    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-    SDL_RenderDrawPoint(renderer, int(position.x - window->x), int(position.y - window->y));
-}
\ No newline at end of file
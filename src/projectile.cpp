@@ -2,6 +2,8 @@
 #include "../include/utils.h"
 #include "../include/player.h"
 #include "../include/window.h"
+#include "../include/render_snapshot.h"
+#include "../include/state_stream.h"
 #include <iostream>
 
 Projectile::Projectile(
@@ -16,7 +18,7 @@ Projectile::Projectile(
     GameObject(pos, dims, vel, scope, r, g, b, a, speed),
     window(window)
 {
-    texture = TextureManager::getTexture(fetchResourcePath("projectile.png"), window->renderer);
+    texture = window->textures.getTexture(fetchResourcePath("projectile.png"), window->renderer);
     initCircleCollision();
 }
 
@@ -26,29 +28,26 @@ Projectile::~Projectile() {
     }
 }
 
-void Projectile::draw(SDL_Renderer* renderer) {
-    Vector2D p = getPosition();
-    Vector2D d = getDimensions();
-    SDL_Rect rect = {
-        int(p.x - window->x - d.x/2),
-        int(p.y - window->y - d.y/2),
-        int(d.x),
-        int(d.y)
-    };
-    SDL_Point center = {rect.w/2, rect.h/2};
-    float angleDeg = angle * 180.0f / M_PI;
-    SDL_RenderCopyEx(
-        renderer, 
-        texture, 
-        nullptr, 
-        &rect, 
-        angleDeg, 
-        &center, 
-        SDL_FLIP_NONE);
+bool Projectile::writeSnapshot(RenderEntity& out) const {
+    if (!GameObject::writeSnapshot(out)) return false;
+    // the projectile texture is drawn untinted
+    out.color[0] = out.color[1] = out.color[2] = out.color[3] = 255;
+    return true;
+}
+
+void Projectile::saveState(StateWriter& out) const {
+    GameObject::saveState(out);
+    out.write(damage);
+}
+
+void Projectile::loadState(StateReader& in) {
+    GameObject::loadState(in);
+    in.read(damage);
 }
 
 // todo update this to handle global bounds (if needed)
-void Projectile::update(float deltaTime) {
+void Projectile::update(const FrameClock& clock) {
+    float deltaTime = clock.deltaTime;
     if (!isActive) return;
 
     // handle window edge collision
@@ -74,14 +73,17 @@ void Projectile::update(float deltaTime) {
     if (edgeHit != -1) {
         int deltaAmount[4] = {0, 0, 0, 0};
         deltaAmount[edgeHit] = expandAmount;
-        window->createResizeRequest(
-            deltaAmount[0], deltaAmount[1], 
-            deltaAmount[2], deltaAmount[3], 
-            this->speed / 100,
-            0.3f
-        );
+        // other objects may be updating on other threads, the window gets this after the update pass
+        if (context) {
+            context->effects().requestResize(
+                deltaAmount[0], deltaAmount[1], 
+                deltaAmount[2], deltaAmount[3], 
+                this->speed / 100,
+                0.3f
+            );
+        }
         setActive(false); // deactivate the projectile
         return; // exit
     }
-    GameObject::move(vel); // move as normal otherwise
+    motion.velocity = getDirection() * speed; // move as normal otherwise
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "../include/quality_governor.h"
+#include <algorithm>
+#include <iostream>
+
+// cheapest to lose first: things nobody looks at, then looks, then what's on screen, then the game itself
+const QualityKnobs QualityGovernor::levels[QualityGovernor::levelCount] = {
+    // spawnRate, cosmetics, healthBars, debugOverlays, lodMargin
+    {1.0f,  true,  true,  true,  1.0f},
+    {1.0f,  true,  true,  false, 0.5f},
+    {1.0f,  false, true,  false, 0.25f},
+    {0.75f, false, false, false, 0.25f},
+    {0.5f,  false, false, false, 0.0f},
+};
+
+QualityGovernor::QualityGovernor(const Settings& settings) :
+    settings(settings)
+{
+    this->settings.window = std::max<size_t>(this->settings.window, 1);
+    this->settings.evaluateEvery = std::max<size_t>(this->settings.evaluateEvery, 1);
+    samples.resize(this->settings.window);
+    sorted.reserve(this->settings.window);
+}
+
+bool QualityGovernor::addSample(float seconds) {
+    samples[next] = seconds;
+    next = (next + 1) % samples.size();
+    filled = std::min(filled + 1, samples.size());
+    sampleCount++;
+    framesAt[level]++;
+
+    // a full window before the first call after a change, otherwise one slow frame would do it
+    if (++sinceEvaluation < settings.evaluateEvery || filled < samples.size()) return false;
+    sinceEvaluation = 0;
+
+    int before = level;
+    evaluate();
+    return level != before;
+}
+
+void QualityGovernor::evaluate() {
+    sorted.assign(samples.begin(), samples.end());
+    size_t p50Index = sorted.size() / 2;
+    size_t p95Index = std::min(sorted.size() - 1, sorted.size() * 95 / 100);
+    std::nth_element(sorted.begin(), sorted.begin() + p95Index, sorted.end());
+    p95 = sorted[p95Index];
+    std::nth_element(sorted.begin(), sorted.begin() + p50Index, sorted.begin() + p95Index);
+    p50 = sorted[p50Index];
+
+    if (p95 > settings.budget) {
+        underStreak = 0;
+        if (level < levelCount - 1) setLevel(level + 1);
+    } else if (p95 < settings.budget * settings.upRatio) {
+        if (++underStreak >= settings.upHold && level > 0) {
+            setLevel(level - 1);
+        }
+    } else {
+        underStreak = 0; // in the band between, stay put
+    }
+}
+
+void QualityGovernor::setLevel(int newLevel) {
+    std::cerr << "Quality level " << level << " -> " << newLevel << " (p95 " << p95 * 1000.0f << " ms, budget "
+              << settings.budget * 1000.0f << " ms)" << std::endl;
+    level = newLevel;
+    underStreak = 0;
+    filled = 0;
+    next = 0;
+    changes++;
+}
+
+void QualityGovernor::report(std::ostream& out) const {
+    out << "quality governor: budget " << settings.budget * 1000.0f << " ms, " << changes << " level changes, now level "
+        << level << " (p50 " << p50 * 1000.0f << " ms, p95 " << p95 * 1000.0f << " ms)\n";
+    out << "  frames per level:";
+    for (int i = 0; i < levelCount; i++) {
+        out << ' ' << i << ": " << (sampleCount ? 100.0 * framesAt[i] / sampleCount : 0.0) << '%';
+    }
+    out << '\n';
+}
@@ -0,0 +1,244 @@
+#include "../include/render_snapshot.h"
+#include "../include/frame_arena.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+void drawHealthBar(SDL_Renderer* renderer, const SDL_Rect& spriteRect, float healthRatio) {
+    // move the health bar to the top of the dimension
+    SDL_Rect healthBarRect = {
+        spriteRect.x,
+        spriteRect.y - 10,
+        spriteRect.w,
+        5
+    };
+
+    // max health bar
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderFillRect(renderer, &healthBarRect);
+
+    // current health bar
+    SDL_Rect currentHealthBarRect = {
+        healthBarRect.x,
+        healthBarRect.y,
+        int(healthBarRect.w * healthRatio),
+        healthBarRect.h
+    };
+    // color transition: green -> yellow -> red
+    if (healthRatio > 0.5f) {
+        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // green
+    } else if (healthRatio > 0.25f) {
+        SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255); // yellow
+    } else {
+        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // red
+    }
+    SDL_RenderFillRect(renderer, &currentHealthBarRect);
+}
+
+void drawHull(SDL_Renderer* renderer, const RenderSnapshot& snapshot, const RenderEntity& entity) {
+    const SDL_Rect& bounds = snapshot.windowBounds;
+    const Vector2D* hull = snapshot.debugHulls.data() + entity.hullOffset;
+
+    // draw vertices at runtime
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    for (int i = 0; i < entity.hullCount; i++) {
+        const Vector2D& v1 = hull[i];
+        const Vector2D& v2 = hull[(i + 1) % entity.hullCount];
+        SDL_RenderDrawLine(
+            renderer,
+            int(v1.x - bounds.x), int(v1.y - bounds.y),
+            int(v2.x - bounds.x), int(v2.y - bounds.y)
+        );
+    }
+    // draw center
+    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+    SDL_RenderDrawPoint(renderer, int(entity.position.x - bounds.x), int(entity.position.y - bounds.y));
+}
+
+void drawHud(Window* window, const RenderSnapshot& snapshot) {
+    SDL_Renderer* renderer = window->renderer;
+    // Get the window dimensions to position the text
+    int windowWidth, windowHeight;
+    SDL_GetRendererOutputSize(renderer, &windowWidth, &windowHeight);
+
+    int fontSize = 16;
+
+    // Draw health text at the bottom right of the screen
+    // hud strings are rebuilt every frame, so they live in the frame arena
+    const char* healthText = frameFormat("%d/%d HP", snapshot.playerHealth, snapshot.playerMaxHealth);
+
+    // Position text at bottom right with some padding
+    int textX = windowWidth - (std::strlen(healthText) * (fontSize/2 + 1)) - 10;
+    int textY = windowHeight - fontSize - 10;
+
+    // Change color based on health percentage
+    SDL_Color healthColor;
+    float healthPercent = float(snapshot.playerHealth) / float(snapshot.playerMaxHealth);
+    if (healthPercent <= 0.25f) {
+        // Red for low health (25% or below)
+        healthColor = {255, 0, 0, 255};
+    } else if (healthPercent <= 0.5f) {
+        // Yellow for medium health (50% or below)
+        healthColor = {255, 255, 0, 255};
+    } else {
+        // Green for good health (above 50%)
+        healthColor = {0, 255, 0, 255};
+    }
+
+    renderText(window, healthText, textX, textY, fontSize, healthColor);
+
+    // Draw score text at the top left of the screen
+    const char* scoreText = frameFormat("Score: %d", snapshot.playerScore);
+    SDL_Color scoreColor = {255, 255, 255, 255}; // White color for score
+    renderText(window, scoreText, 10, 10, fontSize, scoreColor);
+
+    // only there while the quality governor has something turned down
+    if (snapshot.qualityLevel > 0) {
+        SDL_Color qualityColor = {160, 160, 160, 255};
+        renderText(window, frameFormat("Quality -%d", snapshot.qualityLevel), 10, 10 + fontSize + 4, fontSize, qualityColor);
+    }
+}
+
+// the whole paused frame: the world as it was (no interpolation, it's not moving), dimmed, the pause text on top
+void drawPaused(Window* window, const RenderSnapshot& snapshot) {
+    SDL_Renderer* renderer = window->renderer;
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    drawSnapshot(window, snapshot, 1.0f);
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 128);
+    SDL_Rect fullscreen = {0, 0, snapshot.windowBounds.w, snapshot.windowBounds.h};
+    SDL_RenderFillRect(renderer, &fullscreen);
+
+    SDL_Color pausedTextColor = {255, 255, 255, 255};
+    int fontSize = 12;
+    renderText(window, "PAUSED", 20, 20, fontSize, pausedTextColor);
+    renderText(window, "Press R to restart", 20, 40, fontSize, pausedTextColor);
+    renderText(window, "Press P to ragequit", 20, 60, fontSize, pausedTextColor);
+}
+
+} // namespace
+
+float snapshotAlpha(const RenderSnapshot& snapshot) {
+    if (snapshot.stepSeconds <= 0.0f) return 1.0f;
+
+    // the sim may have been idle for a bit since it published, keep sliding forward
+    double sincePublish = double(SDL_GetPerformanceCounter() - snapshot.publishCounter) / SDL_GetPerformanceFrequency();
+    float alpha = snapshot.alpha + float(sincePublish / snapshot.stepSeconds);
+    return std::clamp(alpha, 0.0f, 1.0f);
+}
+
+void drawSnapshot(Window* window, const RenderSnapshot& snapshot, float alpha) {
+    SDL_Renderer* renderer = window->renderer;
+    if (!renderer) return; // headless
+    const SDL_Rect& bounds = snapshot.windowBounds;
+
+    for (const RenderEntity& entity : snapshot.entities) {
+        Vector2D p = entity.position;
+        float angle = entity.angle;
+        if (entity.interpolate) {
+            p = entity.previousPosition + (entity.position - entity.previousPosition) * alpha;
+            angle = entity.previousAngle + (entity.angle - entity.previousAngle) * alpha;
+        }
+
+        Vector2D d = entity.dimensions;
+        SDL_Rect rect = {
+            int(p.x - bounds.x - d.x/2),
+            int(p.y - bounds.y - d.y/2),
+            int(d.x),
+            int(d.y)
+        };
+
+        switch (entity.style) {
+            case RenderStyle::Sprite: {
+                // tinting, textures are plain white
+                SDL_SetTextureColorMod(entity.texture, entity.color[0], entity.color[1], entity.color[2]);
+                SDL_SetTextureAlphaMod(entity.texture, entity.color[3]);
+
+                SDL_Point center = {rect.w/2, rect.h/2};
+                float angleDeg = angle * 180.0f / M_PI;
+                SDL_RenderCopyEx(
+                    renderer,
+                    entity.texture,
+                    nullptr,
+                    &rect,
+                    angleDeg,
+                    &center,
+                    SDL_FLIP_NONE
+                );
+                break;
+            }
+
+            case RenderStyle::FilledRect: {
+                // Save the current blend mode
+                SDL_BlendMode oldBlendMode;
+                SDL_GetRenderDrawBlendMode(renderer, &oldBlendMode);
+
+                // Set blend mode to enable alpha blending
+                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+                SDL_SetRenderDrawColor(renderer, entity.color[0], entity.color[1], entity.color[2], entity.color[3]);
+                SDL_RenderFillRect(renderer, &rect);
+
+                // Restore the previous blend mode
+                SDL_SetRenderDrawBlendMode(renderer, oldBlendMode);
+                break;
+            }
+        }
+
+        if (entity.healthRatio >= 0.0f) {
+            drawHealthBar(renderer, rect, entity.healthRatio);
+        }
+        if (entity.hullCount > 0) {
+            drawHull(renderer, snapshot, entity);
+        }
+    }
+
+    if (snapshot.hasPlayer) {
+        drawHud(window, snapshot);
+    }
+}
+
+void PausedFrame::release() {
+    if (texture) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    valid = false;
+}
+
+bool PausedFrame::update(Window* window, const RenderSnapshot& snapshot) {
+    int w = snapshot.windowBounds.w, h = snapshot.windowBounds.h;
+    if (valid && snapshot.publishCounter == publishCounter && w == width && h == height) return false;
+
+    SDL_Renderer* renderer = window->renderer;
+    if (!renderer) return false;
+    if (!texture || w != width || h != height) {
+        if (texture) SDL_DestroyTexture(texture);
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (texture) SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+        width = w;
+        height = h;
+    }
+    if (texture) {
+        SDL_SetRenderTarget(renderer, texture);
+        drawPaused(window, snapshot);
+        SDL_SetRenderTarget(renderer, nullptr);
+    }
+    publishCounter = snapshot.publishCounter;
+    valid = true;
+    return true;
+}
+
+void PausedFrame::present(Window* window, const RenderSnapshot& snapshot) {
+    SDL_Renderer* renderer = window->renderer;
+    if (!renderer) return;
+    if (texture) {
+        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    } else {
+        drawPaused(window, snapshot);
+    }
+    SDL_RenderPresent(renderer);
+}
@@ -0,0 +1,238 @@
+#include "../include/rewind_buffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// zero runs shorter than this stay inside the literal, their header would cost more than the bytes
+constexpr size_t minZeroRun = 4;
+
+void writeVarint(std::vector<uint8_t>& out, size_t value) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+size_t readVarint(const uint8_t*& p, const uint8_t* end) {
+    size_t value = 0;
+    int shift = 0;
+    while (p < end) {
+        uint8_t byte = *p++;
+        value |= size_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) break;
+        shift += 7;
+    }
+    return value;
+}
+
+} // namespace
+
+RewindBuffer::RewindBuffer(size_t capacityTicks, int keyframeInterval, size_t memoryBudget) :
+    frames(std::max<size_t>(capacityTicks, 2)),
+    // a delta's keyframe has to outlive it, so there must always be room for at least two groups
+    keyframeInterval(std::clamp<int>(keyframeInterval, 1, int(std::max<size_t>(capacityTicks, 2) / 2))),
+    memoryBudget(memoryBudget)
+{}
+
+void RewindBuffer::setData(Frame& frame, const uint8_t* data, size_t size) {
+    memoryUsed -= frame.data.capacity();
+    frame.data.assign(data, data + size);
+    memoryUsed += frame.data.capacity();
+}
+
+void RewindBuffer::releaseData(Frame& frame) {
+    memoryUsed -= frame.data.capacity();
+    std::vector<uint8_t>().swap(frame.data);
+}
+
+void RewindBuffer::evictOldestGroup() {
+    if (count == 0) return;
+    do {
+        if (head == lastKeyframeSlot) {
+            haveKeyframe = false; // the next record has to start a new group
+        }
+        head = (head + 1) % frames.size();
+        count--;
+    } while (count > 0 && !frames[head].keyframe);
+}
+
+void RewindBuffer::record(uint64_t tick, const std::vector<uint8_t>& state) {
+    if (count == frames.size()) {
+        // the first slot gets reused right away and keeps its memory, the rest of the group gives it back
+        // (only live frames count towards the budget, see below)
+        size_t evictFrom = head;
+        size_t before = count;
+        evictOldestGroup();
+        for (size_t i = 1; i < before - count; i++) {
+            releaseData(frames[(evictFrom + i) % frames.size()]);
+        }
+    }
+
+    size_t index = slot(count);
+    Frame& frame = frames[index];
+    bool keyframe = !haveKeyframe || tick - lastKeyframeTick >= uint64_t(keyframeInterval);
+
+    if (!keyframe) {
+        encodeDelta(frames[lastKeyframeSlot].data, state, scratch);
+        // once things have drifted this far a fresh keyframe is the cheaper option
+        keyframe = scratch.size() >= state.size();
+    }
+
+    if (keyframe) {
+        setData(frame, state.data(), state.size());
+        frame.keyframeSlot = index;
+        haveKeyframe = true;
+        lastKeyframeSlot = index;
+        lastKeyframeTick = tick;
+    } else {
+        setData(frame, scratch.data(), scratch.size());
+        frame.keyframeSlot = lastKeyframeSlot;
+    }
+    frame.tick = tick;
+    frame.keyframe = keyframe;
+    frame.rawSize = state.size();
+    count++;
+
+    // over budget: give the oldest history back, but never the group that's being written
+    while (memoryUsed > memoryBudget && count > 0 && head != lastKeyframeSlot) {
+        size_t evictFrom = head;
+        size_t before = count;
+        evictOldestGroup();
+        for (size_t i = 0; i < before - count; i++) {
+            releaseData(frames[(evictFrom + i) % frames.size()]);
+        }
+    }
+}
+
+bool RewindBuffer::restore(uint64_t tick, std::vector<uint8_t>& out) const {
+    if (count == 0 || tick < oldestTick() || tick > newestTick()) return false;
+
+    // ticks only ever go up, binary search over the ring
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (frames[slot(mid)].tick < tick) lo = mid + 1;
+        else hi = mid;
+    }
+    const Frame& frame = frames[slot(lo)];
+    if (frame.tick != tick) return false;
+
+    if (frame.keyframe) {
+        out.assign(frame.data.begin(), frame.data.end());
+    } else {
+        decodeDelta(frames[frame.keyframeSlot].data, frame, out);
+    }
+    return true;
+}
+
+void RewindBuffer::truncateAfter(uint64_t tick) {
+    while (count > 0 && newestTick() > tick) {
+        count--;
+        releaseData(frames[slot(count)]); // dead now, and the budget loop in record() can't reach it
+    }
+
+    // the keyframe new deltas go against may have been cut off
+    haveKeyframe = false;
+    for (size_t i = count; i-- > 0;) {
+        const Frame& frame = frames[slot(i)];
+        if (frame.keyframe) {
+            haveKeyframe = true;
+            lastKeyframeSlot = slot(i);
+            lastKeyframeTick = frame.tick;
+            break;
+        }
+    }
+}
+
+void RewindBuffer::clear() {
+    for (Frame& frame : frames) {
+        releaseData(frame);
+    }
+    head = 0;
+    count = 0;
+    haveKeyframe = false;
+}
+
+void RewindBuffer::encodeDelta(const std::vector<uint8_t>& key, const std::vector<uint8_t>& state, std::vector<uint8_t>& out) {
+    // format: (zero run, literal length, literal bytes)*, all of it state XOR key
+    // bytes past the end of the key are XORed against zero
+    out.clear();
+    size_t n = state.size();
+    size_t keySize = key.size();
+    auto x = [&](size_t i) -> uint8_t { return state[i] ^ (i < keySize ? key[i] : 0); };
+
+    size_t i = 0;
+    while (i < n) {
+        size_t zeroStart = i;
+        while (i < n && x(i) == 0) i++;
+        size_t zeroRun = i - zeroStart;
+
+        size_t literalStart = i;
+        while (i < n) {
+            if (x(i) != 0) {
+                i++;
+                continue;
+            }
+            size_t j = i;
+            while (j < n && x(j) == 0 && j - i < minZeroRun) j++;
+            if (j - i >= minZeroRun || j == n) break;
+            i = j;
+        }
+
+        writeVarint(out, zeroRun);
+        writeVarint(out, i - literalStart);
+        for (size_t k = literalStart; k < i; k++) {
+            out.push_back(x(k));
+        }
+    }
+}
+
+void RewindBuffer::decodeDelta(const std::vector<uint8_t>& key, const Frame& frame, std::vector<uint8_t>& out) {
+    out.resize(frame.rawSize);
+    size_t keep = std::min(frame.rawSize, key.size());
+    std::memcpy(out.data(), key.data(), keep);
+    std::memset(out.data() + keep, 0, frame.rawSize - keep);
+
+    const uint8_t* p = frame.data.data();
+    const uint8_t* end = p + frame.data.size();
+    size_t position = 0;
+    while (p < end) {
+        position += readVarint(p, end);
+        size_t literal = readVarint(p, end);
+        for (size_t k = 0; k < literal && p < end && position < out.size(); k++) {
+            out[position++] ^= *p++;
+        }
+    }
+}
+
+size_t RewindBuffer::countLiveMemory() const {
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        bytes += frames[slot(i)].data.capacity();
+    }
+    return bytes;
+}
+
+void RewindBuffer::report(std::ostream& out) const {
+    size_t keyframes = 0, keyBytes = 0, deltaBytes = 0, rawBytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        const Frame& frame = frames[slot(i)];
+        rawBytes += frame.rawSize;
+        if (frame.keyframe) {
+            keyframes++;
+            keyBytes += frame.data.size();
+        } else {
+            deltaBytes += frame.data.size();
+        }
+    }
+    size_t deltas = count - keyframes;
+
+    out << "rewind: " << count << " ticks [" << oldestTick() << ", " << newestTick() << "], "
+        << keyframes << " keyframes\n";
+    out << "  " << memoryUsed / 1024 << " KiB held of " << memoryBudget / 1024 << " KiB budget, "
+        << (count ? rawBytes / count : 0) << " B/tick raw, "
+        << (keyframes ? keyBytes / keyframes : 0) << " B/keyframe, "
+        << (deltas ? deltaBytes / deltas : 0) << " B/delta\n";
+}
@@ -0,0 +1,196 @@
+#include "../include/script.h"
+#include "../include/sim_context.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+
+namespace {
+    // one per thread, so starting and stopping scripts never takes a lock (every batch world steps on its own
+    // worker, they'd all be fighting over one). a frame freed on another thread than it came from just goes
+    // on that thread's free list, so the chunks are never given back, not even when their thread exits
+    struct FramePool {
+        std::vector<unsigned char*> chunks;
+        std::vector<void*> freeBlocks;
+        std::atomic<size_t> oversized{0};
+    };
+
+    // every pool ever made, only touched when a thread makes its first frame (and by getOversized())
+    struct PoolRegistry {
+        std::mutex mutex;
+        std::vector<FramePool*> pools;
+    };
+
+    PoolRegistry& poolRegistry() {
+        static PoolRegistry* registry = new PoolRegistry(); // never destroyed either, frames may outlive exit()
+        return *registry;
+    }
+
+    FramePool& framePool() {
+        thread_local FramePool* pool = [] {
+            FramePool* created = new FramePool();
+            PoolRegistry& registry = poolRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.pools.push_back(created);
+            return created;
+        }();
+        return *pool;
+    }
+}
+
+void* ScriptFramePool::allocate(size_t size) {
+    FramePool& pool = framePool();
+    if (size > blockSize) {
+        pool.oversized.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+    if (pool.freeBlocks.empty()) {
+        // blockSize is a multiple of the max alignment, so every block in the chunk is aligned too
+        static_assert(blockSize % alignof(std::max_align_t) == 0, "frame blocks have to stay aligned");
+        unsigned char* chunk = new unsigned char[blockSize * blocksPerChunk];
+        pool.chunks.push_back(chunk);
+        for (size_t i = blocksPerChunk; i-- > 0;) {
+            pool.freeBlocks.push_back(chunk + i * blockSize);
+        }
+    }
+    void* block = pool.freeBlocks.back();
+    pool.freeBlocks.pop_back();
+    return block;
+}
+
+void ScriptFramePool::release(void* frame, size_t size) {
+    if (size > blockSize) {
+        ::operator delete(frame);
+        return;
+    }
+    framePool().freeBlocks.push_back(frame);
+}
+
+size_t ScriptFramePool::getOversized() {
+    PoolRegistry& registry = poolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    size_t oversized = 0;
+    for (FramePool* pool : registry.pools) {
+        oversized += pool->oversized.load(std::memory_order_relaxed);
+    }
+    return oversized;
+}
+
+WaitTicks waitSeconds(float seconds) {
+    return WaitTicks{SimContext::ticksFor(seconds)};
+}
+
+ScriptScheduler::~ScriptScheduler() {
+    reset(tick);
+}
+
+ScriptHandle ScriptScheduler::start(ScriptTask task) {
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        index = uint32_t(slots.size());
+        slots.emplace_back();
+    }
+
+    Slot& slot = slots[index];
+    slot.frame = task.release();
+    slot.frame.promise().scheduler = this;
+    slot.frame.promise().slot = index;
+    slot.waitingOn = nullptr;
+    slot.wake = wheel.schedule(tick + 1, 0, nullptr, index);
+    return ScriptHandle{index, slot.generation};
+}
+
+bool ScriptScheduler::isRunning(const ScriptHandle& handle) const {
+    return handle.index < slots.size() &&
+           slots[handle.index].generation == handle.generation &&
+           slots[handle.index].frame;
+}
+
+bool ScriptScheduler::stop(ScriptHandle& handle) {
+    if (!isRunning(handle)) return false;
+    destroy(handle.index);
+    handle = ScriptHandle();
+    return true;
+}
+
+void ScriptScheduler::destroy(uint32_t index) {
+    Slot& slot = slots[index];
+    slot.frame.destroy();
+    slot.frame = nullptr;
+    slot.generation++;
+    slot.waitingOn = nullptr;
+    wheel.cancel(slot.wake);
+    freeSlots.push_back(index);
+}
+
+void ScriptScheduler::resume(uint32_t index) {
+    // the script may start others and grow slots, don't hold on to the reference
+    ScriptTask::Handle frame = slots[index].frame;
+    frame.resume();
+    if (frame.done()) {
+        destroy(index);
+    }
+}
+
+void ScriptScheduler::sleepUntil(uint32_t slot, uint64_t due) {
+    slots[slot].wake = wheel.schedule(due, 0, nullptr, slot);
+}
+
+ScriptHandle ScriptScheduler::waitFor(uint32_t slot, const ScriptEvent* event) {
+    slots[slot].waitingOn = event;
+    return ScriptHandle{slot, slots[slot].generation};
+}
+
+void ScriptScheduler::wake(ScriptHandle handle, const ScriptEvent* event) {
+    if (!isRunning(handle) || slots[handle.index].waitingOn != event) return;
+    slots[handle.index].waitingOn = nullptr;
+    ready.push_back(handle);
+}
+
+void ScriptScheduler::run(const FrameClock& clock) {
+    tick = clock.tick;
+    deltaTime = clock.deltaTime;
+
+    wheel.advance(tick, [this](const TimingWheel::Event& event) {
+        slots[event.data].wake = TimerHandle();
+        resume(event.data);
+    });
+
+    // signalled since the last run, anything signalled while these run waits for the next one
+    readyNow.swap(ready);
+    for (ScriptHandle handle : readyNow) {
+        if (isRunning(handle)) {
+            resume(handle.index);
+        }
+    }
+    readyNow.clear();
+}
+
+void ScriptScheduler::reset(uint64_t tick) {
+    for (uint32_t i = 0; i < slots.size(); i++) {
+        if (slots[i].frame) {
+            destroy(i);
+        }
+    }
+    wheel.reset(tick);
+    ready.clear();
+    this->tick = tick;
+}
+
+void ScriptEvent::signal() {
+    if (!scheduler) return;
+    for (ScriptHandle handle : waiters) {
+        scheduler->wake(handle, this);
+    }
+    waiters.clear();
+}
+
+void ScriptEvent::addWaiter(ScriptTask::Handle frame) {
+    scheduler = frame.promise().scheduler;
+    // scripts that were stopped or reset while waiting would otherwise pile up here
+    std::erase_if(waiters, [this](const ScriptHandle& handle) { return !scheduler->isRunning(handle); });
+    waiters.push_back(scheduler->waitFor(frame.promise().slot, this));
+}
@@ -0,0 +1,118 @@
+#include "../include/shape_library.h"
+#include <array>
+#include <algorithm>
+
+namespace {
+
+// std::sin/cos/sqrt aren't constexpr, small series versions are plenty for a handful of table entries
+constexpr double PI = 3.14159265358979323846;
+
+constexpr double constexprSin(double x) {
+    // reduce to [-pi, pi]
+    while (x > PI) x -= 2 * PI;
+    while (x < -PI) x += 2 * PI;
+    double term = x, sum = x;
+    for (int n = 1; n < 12; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexprCos(double x) {
+    return constexprSin(x + PI / 2);
+}
+
+constexpr double constexprSqrt(double x) {
+    if (x <= 0) return 0;
+    double guess = x > 1 ? x : 1;
+    for (int i = 0; i < 32; i++) {
+        guess = 0.5 * (guess + x / guess);
+    }
+    return guess;
+}
+
+template <size_t N>
+struct Hull {
+    std::array<Vector2D, N> vertices;
+    std::array<Vector2D, N> normals;
+    float boundingRadius;
+};
+
+template <size_t N>
+constexpr Hull<N> makeHull(const std::array<Vector2D, N>& vertices) {
+    Hull<N> hull{vertices, {}, 0.0f};
+    double radiusSquared = 0;
+    for (size_t i = 0; i < N; i++) {
+        const Vector2D& p1 = vertices[i];
+        const Vector2D& p2 = vertices[(i + 1) % N];
+        // same normal as the old per-frame getAxes: (-edge.y, edge.x)
+        hull.normals[i] = Vector2D(-(p2.y - p1.y), p2.x - p1.x);
+        double d = double(p1.x) * p1.x + double(p1.y) * p1.y;
+        radiusSquared = d > radiusSquared ? d : radiusSquared;
+    }
+    hull.boundingRadius = float(constexprSqrt(radiusSquared));
+    return hull;
+}
+
+// todo: how many vertices is a "good enough" approximation?
+constexpr int circleVertexCount = 12;
+
+constexpr std::array<Vector2D, circleVertexCount> makeCircle() {
+    std::array<Vector2D, circleVertexCount> out{};
+    for (int i = 0; i < circleVertexCount; i++) {
+        double a = (2 * PI / circleVertexCount) * i;
+        out[i] = Vector2D(float(0.5 * constexprCos(a)), float(0.5 * constexprSin(a)));
+    }
+    return out;
+}
+
+constexpr auto rectangleHull = makeHull<4>({
+    Vector2D(-0.5f, -0.5f),
+    Vector2D(+0.5f, -0.5f),
+    Vector2D(+0.5f, +0.5f),
+    Vector2D(-0.5f, +0.5f)
+});
+
+constexpr auto circleHull = makeHull(makeCircle());
+
+constexpr auto triangleHull = makeHull<3>({
+    Vector2D(0.0f, -0.5f),  // top vertex (pointing up)
+    Vector2D(-0.5f, 0.5f),  // bottom left
+    Vector2D(0.5f, 0.5f)    // bottom right
+});
+
+// the pentagon texture isn't a regular pentagon, the bottom corners are pulled in
+// (used to be 18px / 4px on a 100x100 pentagon, now as a fraction of the size)
+constexpr auto pentagonHull = makeHull<5>({
+    Vector2D(0.0f, -0.5f),           // top
+    Vector2D(0.5f, -1.0f / 6.0f),    // top right
+    Vector2D(0.32f, 0.46f),          // bottom right
+    Vector2D(-0.32f, 0.46f),         // bottom left
+    Vector2D(-0.5f, -1.0f / 6.0f)    // top left
+});
+
+template <size_t N>
+constexpr ShapePrototype makePrototype(ShapeKind kind, const Hull<N>& hull) {
+    return ShapePrototype{kind, hull.vertices.data(), hull.normals.data(), int(N), hull.boundingRadius};
+}
+
+constexpr ShapePrototype prototypes[] = {
+    makePrototype(ShapeKind::Rectangle, rectangleHull),
+    makePrototype(ShapeKind::Circle, circleHull),
+    makePrototype(ShapeKind::Triangle, triangleHull),
+    makePrototype(ShapeKind::Pentagon, pentagonHull)
+};
+
+static_assert(sizeof(prototypes) / sizeof(prototypes[0]) == size_t(ShapeKind::Count),
+              "every ShapeKind needs a prototype");
+
+} // namespace
+
+const ShapePrototype& ShapeLibrary::get(ShapeKind kind) {
+    return prototypes[static_cast<int>(kind)];
+}
+
+float ShapeLibrary::boundingRadius(const ShapePrototype& shape, const Vector2D& dims) {
+    return shape.boundingRadius * std::max(std::abs(dims.x), std::abs(dims.y));
+}
@@ -0,0 +1,324 @@
+#include "../include/simulation_thread.h"
+#include "../include/player.h"
+#include "../include/globals.h"
+#include "../include/frame_arena.h"
+#include "../include/alloc_tracker.h"
+#include "../include/utils.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <tuple>
+
+SimulationThread::SimulationThread(GameManager& gameManager, Window* window, Player* player) :
+    gameManager(gameManager),
+    window(window),
+    player(player),
+    timestep(float(simulationHz), maxCatchUpSteps)
+{}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::setHashLog(const std::string& path) {
+    hashLog.open(path);
+    if (!hashLog) {
+        std::cerr << "Could not open hash log " << path << std::endl;
+    }
+}
+
+void SimulationThread::enableRewind(float seconds, size_t memoryBudget) {
+    rewindSeconds = seconds;
+    size_t ticks = size_t(seconds * simulationHz);
+    // a keyframe every half second: restores stay one delta away, keyframes stay rare
+    rewind = std::make_unique<RewindBuffer>(ticks, simulationHz / 2, memoryBudget);
+}
+
+void SimulationThread::start() {
+    if (running.exchange(true)) return;
+    // publish once up front so the main thread has something to draw straight away
+    publishSnapshot();
+    thread = std::thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop() {
+    running = false;
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+    }
+    idleWake.notify_one();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (recorder) {
+        recorder->finish(simStep, gameManager.computeStateHash());
+        std::cerr << "Recorded " << recorder->getEventCount() << " input events over " << simStep << " steps" << std::endl;
+        recorder.reset();
+    }
+}
+
+bool SimulationThread::startRecording(const std::string& path) {
+    RecordingHeader header;
+    header.seed = gameManager.getContext().seed;
+    header.simulationHz = uint32_t(simulationHz);
+    std::tie(header.displayWidth, header.displayHeight) = getResolution();
+    if (rewind) {
+        header.rewindSeconds = rewindSeconds;
+        header.rewindBudget = rewind->getMemoryBudget();
+    }
+
+    recorder = std::make_unique<InputRecorder>();
+    if (!recorder->open(path, header)) {
+        recorder.reset();
+        return false;
+    }
+    return true;
+}
+
+void SimulationThread::startReplay(std::unique_ptr<InputReplay> recording) {
+    replay = std::move(recording);
+    if (replay->getHeader().simulationHz != uint32_t(simulationHz)) {
+        std::cerr << "Recording was made at " << replay->getHeader().simulationHz << " hz, this build steps at "
+                  << simulationHz << " hz, it won't replay the same" << std::endl;
+    }
+    // backspace in the recording has to find the same history, or lack of it, as it did live
+    const RecordingHeader& header = replay->getHeader();
+    if (header.rewindSeconds > 0.0f) {
+        enableRewind(header.rewindSeconds, size_t(header.rewindBudget));
+    } else {
+        rewind.reset();
+        rewindSeconds = 0.0f;
+    }
+}
+
+void SimulationThread::enableAutopilot(float intensity) {
+    autopilot = std::make_unique<Autopilot>(intensity, gameManager.getContext().seed);
+    autopilot->applyPressure(gameManager.getSpawnDirector().getSettings());
+}
+
+void SimulationThread::enableQualityGovernor(const QualityGovernor::Settings& settings) {
+    governor = std::make_unique<QualityGovernor>(settings);
+}
+
+bool SimulationThread::runReplayToEnd() {
+    if (!replay) return false;
+    float step = 1.0f / simulationHz;
+    while (!replay->finished(simStep)) {
+        frameArena().reset();
+        stepOnce(step);
+    }
+    bool match = !replay->isComplete() || gameManager.computeStateHash() == replay->getFinalHash();
+    finishReplay();
+    return match;
+}
+
+void SimulationThread::finishReplay() {
+    if (replay->isComplete()) {
+        uint64_t hash = gameManager.computeStateHash();
+        std::cerr << "Replay finished after " << simStep << " steps, state "
+                  << (hash == replay->getFinalHash() ? "matches" : "DOES NOT match") << " the recording" << std::endl;
+    } else {
+        std::cerr << "Replay finished after " << simStep << " steps (recording has no final state to check)" << std::endl;
+    }
+    replay.reset(); // back to live input
+}
+
+void SimulationThread::pushEvent(const SDL_Event& event) {
+    inputEvents.push(event);
+    // taking the lock once means the sim thread is either still before its empty() check or already waiting
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+    }
+    idleWake.notify_one();
+}
+
+bool SimulationThread::shouldIdle() const {
+    // a replay or the autopilot might be about to unpause, they need the steps to keep coming
+    return gameManager.isPaused() && !replay && !autopilot;
+}
+
+void SimulationThread::waitForInput() {
+    std::unique_lock<std::mutex> lock(idleMutex);
+    idleWake.wait(lock, [this] { return !running || !inputEvents.empty(); });
+}
+
+bool SimulationThread::acquireSnapshot() {
+    if (snapshots.update()) {
+        hasSnapshot = true;
+    }
+    return hasSnapshot;
+}
+
+void SimulationThread::run() {
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 lastCounter = SDL_GetPerformanceCounter();
+
+    while (running) {
+        // the sim thread has its own arena, reset once per loop like the main thread does
+        frameArena().reset();
+
+        // paused steps don't do anything, so don't take them (the step counter is only there to line
+        // recorded input up with state, that doesn't change while paused either)
+        if (shouldIdle()) {
+            waitForInput();
+            lastCounter = SDL_GetPerformanceCounter(); // the pause isn't time the sim owes
+        }
+
+        Uint64 now = SDL_GetPerformanceCounter();
+        float dt = float(double(now - lastCounter) / frequency);
+        lastCounter = now;
+
+        {
+            ALLOC_SCOPE("events");
+            inputEvents.drain([this](SDL_Event&& event) {
+                if (replay) return; // the recording drives the game
+                if (recorder) recorder->record(simStep, event);
+                handleEvent(event);
+            });
+        }
+
+        timestep.addFrameTime(dt);
+        bool stepped = false;
+        while (timestep.consumeStep()) {
+            stepOnce(timestep.getStep());
+            stepped = true;
+            if (replay && replay->finished(simStep)) {
+                finishReplay();
+            }
+        }
+
+        if (stepped) {
+            ALLOC_SCOPE("snapshot");
+            publishSnapshot();
+        }
+
+        if (governor) {
+            simWork += float(double(SDL_GetPerformanceCounter() - now) / frequency);
+            sampleQuality();
+        }
+
+        // sleep until the next step is due
+        float untilNextStep = timestep.getStep() * (1.0f - timestep.getAlpha());
+        std::this_thread::sleep_for(std::chrono::duration<float>(untilNextStep));
+    }
+}
+
+void SimulationThread::stepOnce(float dt) {
+    if (replay) {
+        replay->feed(simStep, [this](const SDL_Event& event) { handleEvent(event); });
+    } else if (autopilot) {
+        autopilot->drive(gameManager, [this](const SDL_Event& event) {
+            if (recorder) recorder->record(simStep, event);
+            handleEvent(event);
+        });
+    }
+
+    if (!gameManager.isPaused()) {
+        window->update(dt);
+    }
+    gameManager.update(dt);
+    simStep++;
+
+    uint64_t tick = gameManager.getClock().tick;
+    if (hashLog && gameManager.getContext().deterministic && tick != lastLoggedTick) {
+        hashLog << tick << ' ' << std::hex << gameManager.getStateHash() << std::dec << '\n';
+        lastLoggedTick = tick;
+    }
+
+    if (rewind) {
+        recordRewind();
+    }
+}
+
+void SimulationThread::handleEvent(const SDL_Event& event) {
+    // pause/resume
+    if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) {
+        if (gameManager.getGameState() == GameState::RUNNING) {
+            gameManager.pauseGame();
+        } else if (gameManager.getGameState() == GameState::PAUSED) {
+            gameManager.resumeGame();
+        }
+    // restart
+    } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_r) {
+        if (gameManager.getGameState() == GameState::PAUSED ||
+            gameManager.getGameState() == GameState::GAME_OVER) {
+            gameManager.restartGame();
+            if (rewind) {
+                rewind->clear(); // the clock starts over, old ticks mean nothing now
+            }
+
+            // Find the active player after restart
+            refreshPlayer();
+        }
+    // rewind a second
+    } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_BACKSPACE) {
+        if (rewind && gameManager.getGameState() == GameState::PAUSED) {
+            rewindBy(simulationHz);
+        }
+    } else {
+        checkMovement(event, gameManager.getContext().input);
+
+        // Only process player input if game is running and player pointer is valid
+        if (gameManager.getGameState() == GameState::RUNNING && player && player->getActive()) {
+            gameManager.handleInput(event, player);
+        }
+    }
+}
+
+void SimulationThread::refreshPlayer() {
+    player = gameManager.findPlayer();
+}
+
+void SimulationThread::recordRewind() {
+    uint64_t tick = gameManager.getClock().tick;
+    if (tick == lastRecordedTick && !rewind->empty()) return; // paused, nothing new
+    gameManager.saveWorld(worldScratch);
+    rewind->record(tick, worldScratch);
+    lastRecordedTick = tick;
+}
+
+void SimulationThread::rewindBy(uint64_t ticks) {
+    uint64_t now = gameManager.getClock().tick;
+    uint64_t target = now > ticks ? now - ticks : 0;
+    target = std::max(target, rewind->oldestTick());
+    if (!rewind->restore(target, worldScratch)) return;
+
+    gameManager.loadWorld(worldScratch.data(), worldScratch.size());
+    gameManager.pauseGame(); // the keyframe was recorded mid-play, stay paused so the player can look around
+    rewind->truncateAfter(target);
+    lastRecordedTick = target;
+    refreshPlayer();
+    publishSnapshot();
+    std::cerr << "Rewound to tick " << target << std::endl;
+}
+
+void SimulationThread::sampleQuality() {
+    uint64_t frames = renderFrames.load(std::memory_order_acquire);
+    if (frames == sampledFrames) return; // nothing drawn since the last sample
+    sampledFrames = frames;
+
+    float sample = std::max(renderWork.load(std::memory_order_relaxed), simWork);
+    simWork = 0.0f;
+    if (governor->addSample(sample)) {
+        gameManager.setQuality(governor->getKnobs());
+    }
+}
+
+void SimulationThread::publishSnapshot() {
+    RenderSnapshot& snapshot = snapshots.writeBuffer();
+    gameManager.buildSnapshot(snapshot);
+    snapshot.simStep = simStep;
+    snapshot.alpha = timestep.getAlpha();
+    snapshot.stepSeconds = timestep.getStep();
+    snapshot.publishCounter = SDL_GetPerformanceCounter();
+    snapshot.qualityLevel = governor ? governor->getLevel() : 0;
+    snapshots.publish();
+
+    bool paused = gameManager.isPaused();
+    if (paused || publishedPaused) {
+        SDL_Event wake{};
+        wake.type = snapshotEvent;
+        SDL_PushEvent(&wake);
+    }
+    publishedPaused = paused;
+}
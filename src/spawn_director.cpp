@@ -0,0 +1,228 @@
+#include "../include/spawn_director.h"
+#include "../include/game_manager.h"
+#include "../include/player.h"
+#include "../include/window.h"
+#include "../include/sim_context.h"
+#include "../include/state_stream.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SpawnDirector::SpawnDirector(GameManager* game, Window* window) :
+    game(game),
+    window(window)
+{
+    for (int kind = 0; kind < int(WaveKind::Count); kind++) {
+        nextWave[kind] = SimContext::ticksFor(settings.intervals[kind]);
+    }
+}
+
+int SpawnDirector::getPendingSpawns() const {
+    int pending = 0;
+    for (int i = 0; i < queueSize; i++) {
+        pending += queue[(queueHead + i) % queueCapacity].remaining;
+    }
+    return pending;
+}
+
+void SpawnDirector::scheduleTimers() {
+    ScriptScheduler& scripts = game->getContext().scripts;
+    scripts.stop(waveScript);
+    waveScript = scripts.start(runWaves());
+}
+
+ScriptTask SpawnDirector::runWaves() {
+    SimContext& context = game->getContext();
+    for (;;) {
+        co_await waitUntil(*std::min_element(std::begin(nextWave), std::end(nextWave)));
+
+        uint64_t tick = context.scripts.now();
+        Player* target = game->findPlayer();
+        for (int kind = 0; kind < int(WaveKind::Count); kind++) {
+            if (nextWave[kind] > tick) continue;
+            if (target) {
+                schedule(WaveKind(kind), context);
+            }
+            nextWave[kind] = tick + SimContext::ticksFor(settings.intervals[kind] / std::max(settings.rateScale, 0.01f));
+        }
+    }
+}
+
+void SpawnDirector::update(Player* target, int liveEnemies) {
+    SimContext& context = game->getContext();
+    if (queueSize == 0 || !target) return;
+
+    int allowed = std::min(settings.spawnsPerStep, settings.liveCap - liveEnemies);
+    if (allowed <= 0) {
+        throttledSteps++;
+        return;
+    }
+
+    // oldest wave first, a big wave trickles out over a few steps
+    // one that can't go out right now (pentagons or a beam with no live player) keeps its place, the ones
+    // behind it still go. whatever's left is packed back down in the same order
+    int kept = 0;
+    for (int i = 0; i < queueSize; i++) {
+        Wave wave = queue[(queueHead + i) % queueCapacity];
+        if (allowed > 0) {
+            int count = release(wave, std::min<int>(allowed, wave.remaining), target, context);
+            wave.remaining -= count;
+            allowed -= count;
+        }
+        if (wave.remaining > 0) {
+            queue[(queueHead + kept++) % queueCapacity] = wave;
+        }
+    }
+    queueSize = kept;
+}
+
+void SpawnDirector::schedule(WaveKind kind, SimContext& context) {
+    if (queueSize == queueCapacity) {
+        droppedWaves++; // way behind already, more of the same won't help
+        return;
+    }
+
+    Wave wave{kind, 1, 0};
+    switch (kind) {
+        case WaveKind::Triangles:
+            wave.margin = int16_t(context.randomInt(50, 100));
+            wave.remaining = uint8_t(context.randomInt(1, 4));
+            break;
+        case WaveKind::Beam:
+            break;
+        case WaveKind::Pentagons:
+            wave.remaining = uint8_t(context.randomInt(1, 3));
+            break;
+        default:
+            return;
+    }
+    queue[(queueHead + queueSize) % queueCapacity] = wave;
+    queueSize++;
+}
+
+int SpawnDirector::release(Wave& wave, int count, Player* target, SimContext& context) {
+    switch (wave.kind) {
+        case WaveKind::Triangles: {
+            SDL_Rect bounds = window->getBounds();
+
+            // edge + spot along it, rolled a batch of triangles at a time (the same numbers as one big fill)
+            constexpr int batch = 4;
+            float rolls[2 * batch];
+            for (int first = 0; first < count; first += batch) {
+                int n = std::min(count - first, batch);
+                context.fillRandom(rolls, 2 * n, 0.0f, 1.0f);
+
+                for (int i = 0; i < n; i++) {
+                    int edge = std::min(int(rolls[2 * i] * 4), 3); // 0: top, 1: bottom, 2: left, 3: right
+                    float along = rolls[2 * i + 1];
+                    Vector2D spawnPos;
+                    switch (edge) {
+                        case 0:
+                            spawnPos = Vector2D(bounds.x + std::floor(along * (bounds.w + 1)), bounds.y - wave.margin);
+                            break;
+                        case 1:
+                            spawnPos = Vector2D(bounds.x + std::floor(along * (bounds.w + 1)), bounds.y + bounds.h + wave.margin);
+                            break;
+                        case 2:
+                            spawnPos = Vector2D(bounds.x - wave.margin, bounds.y + std::floor(along * (bounds.h + 1)));
+                            break;
+                        case 3:
+                            spawnPos = Vector2D(bounds.x + bounds.w + wave.margin, bounds.y + std::floor(along * (bounds.h + 1)));
+                            break;
+                    }
+                    Vector2D spawnDir = (target->getPosition() - spawnPos).normalize();
+                    game->spawnTriangle(spawnPos, spawnDir, target);
+                }
+            }
+            break;
+        }
+        case WaveKind::Beam:
+            if (!target->getActive()) return 0; // spawnBeam() wouldn't spawn anything
+            game->spawnBeam(target);
+            break;
+        case WaveKind::Pentagons: {
+            if (!target->getActive()) return 0; // placed around the player, nowhere to put them
+            auto [screenW, screenH] = getResolution();
+            SDL_Rect screen = {0, 0, screenW, screenH};
+            for (int i = 0; i < count; i++) {
+                Vector2D spawnPos = placeAround(target->getPosition(), settings.pentagonMinDistance, screen, context);
+                game->spawnPentagon(spawnPos, target);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    spawned += count;
+    return count;
+}
+
+// a point in area that's at least minDistance from center (the annulus around the player, cut to the screen)
+// pick a direction, find where that ray leaves the area, pick a distance between minDistance and that.
+// area weighted along the ray so it's close to uniform, and every accepted sample is valid by construction
+Vector2D SpawnDirector::placeAround(Vector2D center, float minDistance, const SDL_Rect& area, SimContext& context) {
+    float left = float(area.x), right = float(area.x + area.w);
+    float top = float(area.y), bottom = float(area.y + area.h);
+    center.x = std::clamp(center.x, left, right);
+    center.y = std::clamp(center.y, top, bottom);
+
+    auto exitDistance = [&](Vector2D dir) {
+        float t = std::numeric_limits<float>::max();
+        if (dir.x > 0) t = std::min(t, (right - center.x) / dir.x);
+        if (dir.x < 0) t = std::min(t, (left - center.x) / dir.x);
+        if (dir.y > 0) t = std::min(t, (bottom - center.y) / dir.y);
+        if (dir.y < 0) t = std::min(t, (top - center.y) / dir.y);
+        return t;
+    };
+    auto pickRadius = [&](float from, float to) {
+        return std::sqrt(from * from + context.randomFloat(0.0f, 1.0f) * (to * to - from * from));
+    };
+
+    for (int attempt = 0; attempt < settings.placementAttempts; attempt++) {
+        float angle = context.randomFloat(0.0f, 2 * M_PI);
+        Vector2D dir(std::cos(angle), std::sin(angle));
+        float exit = exitDistance(dir);
+        if (exit >= minDistance) {
+            return center + dir * pickRadius(minDistance, exit);
+        }
+    }
+
+    // what's left of the screen is a thin sliver or nothing at all, head for the farthest corner
+    fallbackPlacements++;
+    Vector2D corner(center.x - left > right - center.x ? left : right,
+                    center.y - top > bottom - center.y ? top : bottom);
+    Vector2D toCorner = corner - center;
+    float reach = toCorner.magnitude();
+    if (reach <= 0.0f) return center;
+    return center + toCorner / reach * pickRadius(std::min(minDistance, reach), reach);
+}
+
+void SpawnDirector::saveState(StateWriter& out) const {
+    out.write(nextWave);
+    out.write(queueSize);
+    for (int i = 0; i < queueSize; i++) {
+        out.write(queue[(queueHead + i) % queueCapacity]);
+    }
+}
+
+void SpawnDirector::loadState(StateReader& in) {
+    in.read(nextWave);
+    waveScript = ScriptHandle(); // the scheduler was reset along with everything else, see scheduleTimers()
+    in.read(queueSize);
+    queueSize = std::clamp(queueSize, 0, queueCapacity);
+    queueHead = 0;
+    for (int i = 0; i < queueSize; i++) {
+        in.read(queue[i]);
+    }
+}
+
+void SpawnDirector::addToHash(StateHash& hash) const {
+    hash.add(nextWave);
+    hash.add(getPendingSpawns());
+}
+
+void SpawnDirector::report(std::ostream& out) const {
+    out << "spawns: " << spawned << " released, " << getPendingSpawns() << " pending, "
+        << throttledSteps << " throttled steps, " << droppedWaves << " dropped waves, "
+        << fallbackPlacements << " fallback placements" << std::endl;
+}
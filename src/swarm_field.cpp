@@ -0,0 +1,122 @@
+#include "../include/swarm_field.h"
+#include <algorithm>
+#include <cmath>
+
+void SwarmField::begin(const SDL_Rect& bounds) {
+    settings.cellSize = std::max(settings.cellSize, 1.0f);
+    settings.separationRadius = std::min(settings.separationRadius, settings.cellSize);
+
+    originX = float(bounds.x) - settings.margin;
+    originY = float(bounds.y) - settings.margin;
+    columns = std::max(1, int(std::ceil((float(bounds.w) + 2.0f * settings.margin) / settings.cellSize)));
+    rows = std::max(1, int(std::ceil((float(bounds.h) + 2.0f * settings.margin) / settings.cellSize)));
+
+    hasTarget = false;
+    flowReady = false;
+    pending.clear();
+    pendingCells.clear();
+}
+
+int SwarmField::cellOf(Vector2D position) const {
+    int x = int(std::floor((position.x - originX) / settings.cellSize));
+    int y = int(std::floor((position.y - originY) / settings.cellSize));
+    if (x < 0 || y < 0 || x >= columns || y >= rows) return -1;
+    return y * columns + x;
+}
+
+void SwarmField::add(Vector2D position) {
+    if (!settings.enabled) return;
+    int cell = cellOf(position);
+    if (cell < 0) return; // far out, nothing out there is close enough to anything on screen to matter
+    pending.push_back(position);
+    pendingCells.push_back(uint32_t(cell));
+}
+
+void SwarmField::build() {
+    size_t cells = size_t(columns) * size_t(rows);
+
+    // counting sort by cell, stable so a cell's members are in the same order every run
+    cellStart.assign(cells + 1, 0);
+    for (uint32_t cell : pendingCells) {
+        cellStart[cell + 1]++;
+    }
+    for (size_t c = 0; c < cells; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    cursor.assign(cellStart.begin(), cellStart.end() - 1);
+    members.resize(pending.size());
+    for (size_t i = 0; i < pending.size(); i++) {
+        members[cursor[pendingCells[i]]++] = pending[i];
+    }
+
+    // nobody to steer, no point filling in the field
+    if (!settings.enabled || !hasTarget || members.empty()) return;
+    if (flow.size() != cells) {
+        flow.assign(cells, Vector2D(0, 0));
+        flowStamp.assign(cells, 0);
+        buildStamp = 0;
+    }
+    if (++buildStamp == 0) { // wrapped, every old stamp could look current
+        std::fill(flowStamp.begin(), flowStamp.end(), 0);
+        buildStamp = 1;
+    }
+
+    // a member only ever reads its own cell
+    for (uint32_t cell : pendingCells) {
+        if (flowStamp[cell] == buildStamp) continue;
+        flowStamp[cell] = buildStamp;
+        int x = int(cell) % columns, y = int(cell) / columns;
+        Vector2D center(originX + (float(x) + 0.5f) * settings.cellSize,
+                        originY + (float(y) + 0.5f) * settings.cellSize);
+        flow[cell] = (target - center).normalize();
+    }
+    flowReady = true;
+}
+
+Vector2D SwarmField::flowAt(Vector2D position, Vector2D target) const {
+    Vector2D direct = target - position;
+    if (!flowReady || !(target == this->target)) return direct.normalize();
+
+    // within a couple of cells one direction per cell is too coarse (and right next to it the cell's center
+    // can be on the far side of the target)
+    float nearby = 2.0f * settings.cellSize;
+    if (direct.lengthSquared() < nearby * nearby) return direct.normalize();
+
+    // the cell it's in, no blending: one load instead of a square root per triangle
+    // only filled in where members are, anywhere else may not be from this build
+    int cell = cellOf(position);
+    if (cell < 0 || flowStamp[cell] != buildStamp) return direct.normalize();
+    return flow[cell];
+}
+
+Vector2D SwarmField::separation(Vector2D position) const {
+    if (!settings.enabled || members.empty()) return Vector2D(0, 0);
+    int cell = cellOf(position);
+    if (cell < 0) return Vector2D(0, 0);
+    int cx = cell % columns, cy = cell / columns;
+
+    float radius = settings.separationRadius;
+    float radiusSquared = radius * radius;
+    Vector2D push(0, 0);
+    int found = 0;
+    int limit = settings.maxNeighbours;
+    for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, rows - 1) && found < limit; y++) {
+        for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, columns - 1) && found < limit; x++) {
+            size_t c = size_t(y) * columns + x;
+            for (uint32_t k = cellStart[c]; k < cellStart[c + 1] && found < limit; k++) {
+                Vector2D away = position - members[k];
+                float distanceSquared = away.lengthSquared();
+                if (distanceSquared == 0.0f || distanceSquared >= radiusSquared) continue;
+                // 1 when touching, 0 at the edge of the radius
+                float distance = std::sqrt(distanceSquared);
+                push += away * ((radius - distance) / (radius * distance));
+                found++;
+            }
+        }
+    }
+
+    // one neighbour right on top counts as much as a whole crowd, otherwise the crowd would win over homing
+    float length = push.magnitude();
+    if (length > 1.0f) push /= length;
+    return push * settings.separationWeight;
+}
@@ -0,0 +1,109 @@
+#include "../include/timing_wheel.h"
+#include <algorithm>
+
+TimingWheel::TimingWheel(size_t reserve) {
+    nodes.reserve(reserve);
+    std::fill(std::begin(heads), std::end(heads), none);
+}
+
+void TimingWheel::reset(uint64_t tick) {
+    for (Node& node : nodes) {
+        if (node.list >= 0) {
+            node.generation++;
+        }
+        node.list = -1;
+    }
+    // rebuild the free list in index order so a reset wheel hands out slots the same way every time
+    freeHead = none;
+    for (size_t i = nodes.size(); i-- > 0;) {
+        nodes[i].next = freeHead;
+        freeHead = uint32_t(i);
+    }
+    std::fill(std::begin(heads), std::end(heads), none);
+    now = tick;
+    count = 0;
+}
+
+int TimingWheel::listFor(uint64_t due) const {
+    // the lowest level whose slot range still contains both now and due
+    for (int level = 0; level < levels; level++) {
+        int shift = slotBits * (level + 1);
+        if ((due >> shift) == (now >> shift)) {
+            return level * slotsPerLevel + int((due >> (slotBits * level)) & (slotsPerLevel - 1));
+        }
+    }
+    return overflowList;
+}
+
+void TimingWheel::link(uint32_t index, int list) {
+    Node& node = nodes[index];
+    node.list = list;
+    node.prev = none;
+    node.next = heads[list];
+    if (heads[list] != none) {
+        nodes[heads[list]].prev = index;
+    }
+    heads[list] = index;
+}
+
+void TimingWheel::unlink(uint32_t index) {
+    Node& node = nodes[index];
+    if (node.prev != none) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[node.list] = node.next;
+    }
+    if (node.next != none) {
+        nodes[node.next].prev = node.prev;
+    }
+    node.list = -1;
+}
+
+void TimingWheel::release(uint32_t index) {
+    Node& node = nodes[index];
+    node.generation++;
+    node.next = freeHead;
+    freeHead = index;
+    count--;
+}
+
+void TimingWheel::cascade(int list) {
+    uint32_t index = heads[list];
+    heads[list] = none;
+    while (index != none) {
+        uint32_t next = nodes[index].next;
+        link(index, listFor(nodes[index].event.due));
+        index = next;
+    }
+}
+
+TimerHandle TimingWheel::schedule(uint64_t dueTick, uint16_t kind, void* target, uint32_t data) {
+    uint32_t index;
+    if (freeHead != none) {
+        index = freeHead;
+        freeHead = nodes[index].next;
+    } else {
+        index = uint32_t(nodes.size());
+        nodes.push_back(Node{{}, none, none, 0, -1});
+    }
+
+    Node& node = nodes[index];
+    node.event = Event{std::max(dueTick, now + 1), target, data, kind};
+    link(index, listFor(node.event.due));
+    count++;
+    return TimerHandle{index, node.generation};
+}
+
+bool TimingWheel::isPending(const TimerHandle& handle) const {
+    return handle.index < nodes.size() &&
+           nodes[handle.index].generation == handle.generation &&
+           nodes[handle.index].list >= 0;
+}
+
+bool TimingWheel::cancel(TimerHandle& handle) {
+    if (!isPending(handle)) return false;
+    unlink(handle.index);
+    release(handle.index);
+    handle = TimerHandle();
+    return true;
+}
@@ -2,20 +2,14 @@
 #include "../include/utils.h"
 #include "../include/player.h"
 #include "../include/window.h"
+#include "../include/render_snapshot.h"
+#include "../include/sim_context.h"
+#include "../include/state_stream.h"
 #include <iostream>
 #include <algorithm>
 
 void Triangle::initTriangleCollision() {
-    vertices.clear();
-    localVertices.clear();
-
-    // triangle vertices
-    // if im writing a init collision function for every shape i might as well just hardcode it in
-    localVertices.push_back(Vector2D(0, -dimensions.y / 2.0f)); // Top vertex (pointing up)
-    localVertices.push_back(Vector2D(-dimensions.x / 2.0f, dimensions.y / 2.0f)); // Bottom left vertex
-    localVertices.push_back(Vector2D(dimensions.x / 2.0f, dimensions.y / 2.0f)); // Bottom right vertex
-
-    updateCollisionVertices();
+    setShape(ShapeKind::Triangle);
 }
 
 Triangle::Triangle(
@@ -36,8 +30,7 @@ Triangle::Triangle(
     score(3.0f),
     homingTarget(target)
 {
-    texture = TextureManager::getTexture(fetchResourcePath("triangle.png"), window->renderer);
-    spinDirection = (rand() % 2) ? 1 : -1;
+    texture = window->textures.getTexture(fetchResourcePath("triangle.png"), window->renderer);
     initTriangleCollision();
 }
 
@@ -47,43 +40,25 @@ Triangle::~Triangle() {
     }
 }
 
-void Triangle::draw(SDL_Renderer* renderer) {
-    if (!isActive) return;
+bool Triangle::writeSnapshot(RenderEntity& out) const {
+    if (!isActive) return false;
     SDL_Rect windowBounds = window->getBounds();
     if (!isInWindow(windowBounds)) {
-        return;
+        return false;
     }
 
-    Vector2D p = getPosition();
-    Vector2D d = getDimensions();
-    SDL_Rect rect = {
-        int(p.x - window->x - d.x/2),
-        int(p.y - window->y - d.y/2),
-        int(d.x),
-        int(d.y)
-    };
-
-    // tinting
-    SDL_SetTextureColorMod(texture, color[0], color[1], color[2]);
-
-    SDL_Point center = {rect.w/2, rect.h/2};
-    float angleDeg = angle * 180.0f / M_PI;
-    SDL_RenderCopyEx(
-        renderer, 
-        texture, 
-        nullptr, 
-        &rect, 
-        angleDeg, 
-        &center, 
-        SDL_FLIP_NONE
-    );
-
-    // uncomment if debug
-    // drawCollisionVertices(renderer);
-    drawHealthBar(renderer);
+    // the white flash is mixed in here, the color itself never changes
+    GameObject::writeSnapshot(out);
+    if (flashAmount > 0.0f) {
+        for (int i = 0; i < 3; i++) {
+            out.color[i] = Uint8(out.color[i] + (255 - out.color[i]) * flashAmount);
+        }
+    }
+    out.healthRatio = health / maxHealth;
+    return true;
 }
 
-void Triangle::update(float deltaTime) {
+void Triangle::update(const FrameClock&) {
     if (!isActive) return;
     if (getHealth() <= 0) {
         setActive(false);
@@ -91,101 +66,75 @@ void Triangle::update(float deltaTime) {
     }
 
     if (homingTarget) {
-        Vector2D targetPos = homingTarget->getPosition();
-        Vector2D targetDir = (targetPos - position).normalize();
+        // where the player was at the start of the step, it may be mid-update on another thread
+        Vector2D targetPos = homingTarget->getPreviousPosition();
+        Vector2D targetDir = context->swarm.flowAt(position, targetPos);
         if (targetDir.lengthSquared() > 1e-6f) { // epsilon, anything less is not meaningful
             float deviationStrength = 0.2;
-            float deviationX = (((float)rand() / RAND_MAX) * 2.0f - 1.0f) * deviationStrength;
-            float deviationY = (((float)rand() / RAND_MAX) * 2.0f - 1.0f) * deviationStrength;
+            float deviationX = random.range(-1.0f, 1.0f) * deviationStrength;
+            float deviationY = random.range(-1.0f, 1.0f) * deviationStrength;
 
+            // and away from the others, so a wave spreads out instead of arriving as one blob
             Vector2D randomDeviationVector(deviationX, deviationY);
-
-            targetDir = (targetDir + randomDeviationVector).normalize();
+            targetDir = (targetDir + context->swarm.separation(position) + randomDeviationVector).normalize();
             setDirection(targetDir);
         }
     }
 
-    Vector2D vel = getDirection() * speed * deltaTime;
-    // rotate around for fun why not
-    float angleRotate = 60.0f;
-    float dAngle = (float)spinDirection * angleRotate * M_PI / 180.0f * deltaTime;
-    rotate(dAngle);
-
-    // check flashing
-    float currentTime = SDL_GetTicks() / 1000.0f;
-    if (currentTime - lastHitTime < whiteFlashDuration) {
-        setColor(255, 255, 255, 255); // white flash
-    } else {
-        // reset to yellow
-        setColor(255, 255, 0, 255);
+    // spin is only for looks, nobody sees it out past the full rate band
+    if (lod == SimLod::Full && context->cosmetics) {
+        // rotate around for fun why not
+        float angleRotate = 60.0f;
+        motion.spin = (float)spinDirection * angleRotate * M_PI / 180.0f;
     }
 
-    // move
-    GameObject::move(vel);
+    // move, the integrator does the actual moving after everyone's updated (see kinematics.h)
+    motion.velocity = getDirection() * speed;
 
     // does this need any movement restrictions? i'm not sure
 }
 
-void Triangle::drawCollisionVertices(SDL_Renderer* renderer) const {
-    if (!isActive) return;
+void Triangle::saveState(StateWriter& out) const {
+    GameObject::saveState(out);
+    out.write(health);
+    out.write(maxHealth);
+    out.write(score);
+    out.write(flashStartTick);
+    out.write(flashAmount);
+    out.write(spinDirection);
+}
 
-    SDL_Rect windowBounds = window->getBounds();
+void Triangle::loadState(StateReader& in) {
+    GameObject::loadState(in);
+    in.read(health);
+    in.read(maxHealth);
+    in.read(score);
+    in.read(flashStartTick);
+    in.read(flashAmount);
+    in.read(spinDirection);
+}
 
-    // draw vertices at runtime
-    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-    for (size_t i = 0; i < vertices.size(); i++) {
-        const Vector2D& v1 = vertices[i];
-        const Vector2D& v2 = vertices[(i + 1) % vertices.size()];
-        SDL_RenderDrawLine(
-            renderer,
-            int(v1.x - window->x), int(v1.y - window->y),
-            int(v2.x - window->x), int(v2.y - window->y)
-        );
-    }
-    // draw center
-    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-    SDL_RenderDrawPoint(renderer, int(position.x - window->x), int(position.y - window->y));
+void Triangle::changeHealthBy(float delta) {
+    health += delta;
 }
 
-void Triangle::drawHealthBar(SDL_Renderer* renderer) const {
-    // runtime drawing
-    if (!isActive) return;
-    SDL_Rect windowBounds = window->getBounds();
+void Triangle::flash(const FrameClock& clock) {
+    // only for looks: not below full rate (see sim_lod.h) or when the quality governor needs the time
+    if (lod != SimLod::Full || !context->cosmetics) return;
+    // hit again while still white, the flash just starts over
+    context->tweens.cancel(flashTween);
+    flashStartTick = clock.tick;
+    scheduleTimers();
+}
 
-    Vector2D pos = getPosition(); 
-    Vector2D dim = getDimensions();
-
-    // move the health bar to the top of the dimension
-    SDL_Rect healthBarRect = {
-        int(pos.x - windowBounds.x - dim.x / 2),
-        int(pos.y - windowBounds.y - dim.y / 2) - 10,
-        int(dim.x),
-        5
-    };
-
-    // max health bar
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_RenderFillRect(renderer, &healthBarRect);
-
-    // current health bar
-    float healthRatio = health / maxHealth;
-    SDL_Rect currentHealthBarRect = {
-        healthBarRect.x,
-        healthBarRect.y,
-        int(healthBarRect.w * healthRatio),
-        healthBarRect.h
-    };
-    // color transition: green -> yellow -> red
-    if (healthRatio > 0.5f) {
-        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // green
-    } else if (healthRatio > 0.25f) {
-        SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255); // yellow
-    } else {
-        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // red
+void Triangle::scheduleTimers() {
+    // white straight away, back to yellow over whiteFlashDuration
+    uint64_t duration = SimContext::ticksFor(whiteFlashDuration);
+    if (flashStartTick != 0 && flashStartTick + duration > context->tweens.getTick()) {
+        flashTween = context->tweens.start(&flashAmount, 1.0f, 0.0f, flashStartTick, duration, Easing::OutQuad);
     }
-    SDL_RenderFillRect(renderer, &currentHealthBarRect);
 }
 
-void Triangle::changeHealthBy(float delta) {
-    health += delta;
+void Triangle::cancelTimers() {
+    if (context) context->tweens.cancel(flashTween);
 }
\ No newline at end of file
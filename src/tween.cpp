@@ -0,0 +1,185 @@
+#include "../include/tween.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int tableSize = 256;
+
+float exactEase(Easing easing, float t) {
+    switch (easing) {
+        case Easing::OutQuad: return 1.0f - std::pow(1.0f - t, 2);
+        case Easing::OutCubic: return 1.0f - std::pow(1.0f - t, 3);
+        case Easing::OutQuart: return 1.0f - std::pow(1.0f - t, 4);
+        case Easing::OutExpo: return 1.0f - std::pow(2.0f, -10.0f * t);
+        case Easing::Step: return t < 0.5f ? 0.0f : 1.0f;
+        default: return t;
+    }
+}
+
+// tableSize segments per curve, the pow calls only ever happen here, once at startup
+struct EasingTables {
+    float samples[size_t(Easing::Count)][tableSize + 1];
+
+    EasingTables() {
+        for (size_t easing = 0; easing < size_t(Easing::Count); easing++) {
+            for (int i = 0; i <= tableSize; i++) {
+                samples[easing][i] = exactEase(Easing(easing), float(i) / float(tableSize));
+            }
+        }
+    }
+};
+
+const EasingTables tables;
+
+// where in the curve a tween is, p = elapsed / duration
+float curvePosition(TweenMode mode, float p) {
+    switch (mode) {
+        case TweenMode::Loop: return p - std::floor(p);
+        case TweenMode::PingPong: {
+            float cycle = p - 2.0f * std::floor(p * 0.5f);
+            return cycle <= 1.0f ? cycle : 2.0f - cycle;
+        }
+        default: return std::min(p, 1.0f);
+    }
+}
+
+}
+
+float ease(Easing easing, float t) {
+    float x = std::min(std::max(t, 0.0f), 1.0f) * float(tableSize);
+    int i = std::min(int(x), tableSize - 1);
+    const float* samples = tables.samples[size_t(easing)];
+    return samples[i] + (samples[i + 1] - samples[i]) * (x - float(i));
+}
+
+Tweens::Tweens() {
+    // a few hit flashes and a beam or two at a time, this covers a busy wave without growing
+    constexpr size_t reserve = 64;
+    targets.reserve(reserve);
+    from.reserve(reserve);
+    span.reserve(reserve);
+    startTick.reserve(reserve);
+    inverseDuration.reserve(reserve);
+    easings.reserve(reserve);
+    modes.reserve(reserve);
+    owners.reserve(reserve);
+    progress.reserve(reserve);
+    slots.reserve(reserve);
+}
+
+TweenHandle Tweens::start(float* target, float from, float to, uint64_t startTick, uint64_t durationTicks,
+                          Easing easing, TweenMode mode) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = uint32_t(slots.size());
+        slots.push_back(Slot{});
+    }
+    slots[slot].dense = uint32_t(targets.size());
+
+    float inverse = 1.0f / float(std::max<uint64_t>(durationTicks, 1));
+    targets.push_back(target);
+    this->from.push_back(from);
+    span.push_back(to - from);
+    this->startTick.push_back(startTick);
+    inverseDuration.push_back(inverse);
+    easings.push_back(easing);
+    modes.push_back(mode);
+    owners.push_back(slot);
+
+    // already running (started now, or restarted after a load), so it shows the right value before the next advance
+    if (startTick <= now) {
+        float p = float(now - startTick) * inverse;
+        *target = from + (to - from) * ease(easing, curvePosition(mode, p));
+    }
+    return TweenHandle{slot, slots[slot].generation};
+}
+
+bool Tweens::isRunning(const TweenHandle& handle) const {
+    return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+}
+
+bool Tweens::cancel(TweenHandle& handle) {
+    bool running = isRunning(handle);
+    if (running) {
+        remove(slots[handle.index].dense);
+    }
+    handle = TweenHandle();
+    return running;
+}
+
+void Tweens::remove(uint32_t dense) {
+    uint32_t slot = owners[dense];
+    slots[slot].generation++;
+    freeSlots.push_back(slot);
+
+    // last one into the hole
+    size_t last = targets.size() - 1;
+    if (dense != last) {
+        targets[dense] = targets[last];
+        from[dense] = from[last];
+        span[dense] = span[last];
+        startTick[dense] = startTick[last];
+        inverseDuration[dense] = inverseDuration[last];
+        easings[dense] = easings[last];
+        modes[dense] = modes[last];
+        owners[dense] = owners[last];
+        slots[owners[dense]].dense = dense;
+    }
+    targets.pop_back();
+    from.pop_back();
+    span.pop_back();
+    startTick.pop_back();
+    inverseDuration.pop_back();
+    easings.pop_back();
+    modes.pop_back();
+    owners.pop_back();
+}
+
+void Tweens::advance(uint64_t tick) {
+    now = tick;
+    size_t count = targets.size();
+    progress.resize(count);
+
+    // elapsed over duration, negative while a tween is still waiting for its start tick
+    for (size_t i = 0; i < count; i++) {
+        progress[i] = float(int64_t(tick - startTick[i])) * inverseDuration[i];
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        float p = progress[i];
+        if (p < 0.0f) continue;
+        *targets[i] = from[i] + span[i] * ease(easings[i], curvePosition(modes[i], p));
+    }
+
+    // back to front, whatever gets swapped into a hole has been looked at already
+    for (size_t i = count; i-- > 0;) {
+        if (modes[i] == TweenMode::Once && progress[i] >= 1.0f) {
+            remove(uint32_t(i));
+        }
+    }
+}
+
+void Tweens::reset(uint64_t tick) {
+    for (uint32_t slot : owners) {
+        slots[slot].generation++;
+    }
+    targets.clear();
+    from.clear();
+    span.clear();
+    startTick.clear();
+    inverseDuration.clear();
+    easings.clear();
+    modes.clear();
+    owners.clear();
+
+    // handed out lowest first again, so a reset hands out slots the same way every time
+    freeSlots.clear();
+    for (size_t i = slots.size(); i-- > 0;) {
+        freeSlots.push_back(uint32_t(i));
+    }
+    now = tick;
+}
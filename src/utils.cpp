@@ -4,9 +4,8 @@
 
 using namespace std;
 
-std::map<std::string, SDL_Texture*> TextureManager::textures;
-
 SDL_Texture* TextureManager::getTexture(const std::string& path, SDL_Renderer* renderer) {
+    if (!renderer) return nullptr; // headless, nothing to load into
     if (textures.find(path) != textures.end()) {
         return textures[path];
     }
@@ -38,19 +37,33 @@ SDL_Texture* loadTexture(const string& path, SDL_Renderer* renderer) {
 }
 
 string fetchResourcePath(const string& filename) {
-    char* basePath = SDL_GetBasePath();
-    if (basePath) {
-        string path = string(basePath) + "..\\assets\\" + filename;
-        SDL_free(basePath);
-        return path;
-    }
-    else {
+    // the base path doesn't change, only ask SDL once
+    static const string assetDir = []() -> string {
+        char* basePath = SDL_GetBasePath();
+        if (basePath) {
+            string dir = string(basePath) + "..\\assets\\";
+            SDL_free(basePath);
+            return dir;
+        }
         cerr << "Failed to get base path: " << SDL_GetError() << '\n';
-        return "..\\assets\\" + filename; // fallback
+        return "..\\assets\\"; // fallback
+    }();
+    return assetDir + filename;
+}
+
+void preloadTextures(Window* window) {
+    // entities get created on the simulation thread, make sure they only ever hit the cache
+    for (const char* file : {"player.png", "triangle.png", "pentagon.png", "projectile.png"}) {
+        window->textures.getTexture(fetchResourcePath(file), window->renderer);
     }
 }
 
 std::pair<int, int> getResolution() {
+    // cached by init(), the display mode query isn't something to do per beam per frame (or off the main thread)
+    if (displayWidth > 0 && displayHeight > 0) {
+        return {displayWidth, displayHeight};
+    }
+
     SDL_DisplayMode d;
     if (SDL_GetCurrentDisplayMode(0, &d) != 0) {
         std::cerr << "SDL_GetCurrentDisplayMode failed: " << SDL_GetError() << '\n';
@@ -100,6 +113,17 @@ Window* init() {
     return window;
 }
 
+Window* initHeadless() {
+    // no SDL video at all, just pretend there's a 1080p display (unless a replay says otherwise)
+    if (displayWidth <= 0 || displayHeight <= 0) {
+        displayWidth = 1920;
+        displayHeight = 1080 - 50; // same taskbar guess as getResolution
+    }
+    int x = (displayWidth - windowWidth) / 2;
+    int y = (displayHeight - windowHeight) / 2;
+    return new Window(x, y, windowWidth, windowHeight, 0.25f);
+}
+
 Window* createOverlayWindow() {
     std::pair<int, int> resolution = getResolution();
 
@@ -133,107 +157,76 @@ void cleanup(map<string, Window*> windows) {
             pair.second = nullptr;
         }
     }
-    TextureManager::cleanup();
+    // textures and fonts went with their windows
     TTF_Quit();
     IMG_Quit();
     SDL_Quit();
 }
 
-void waitForFrame(int fps, Uint32 frameStart) {
-    if (fps <= 0) return;
-
-    Uint32 frameTime = SDL_GetTicks() - frameStart;
-    int ticks = 1000 / fps;
-    if (frameTime < ticks) {
-        SDL_Delay(ticks - frameTime);
-    }
-}
-
-void checkMovement(SDL_Event event, std::map<std::string, bool>& keyState) {
-    if (event.type == SDL_KEYDOWN) {
-        switch (event.key.keysym.sym) {
-            case SDLK_UP: keyState["up"] = true; break;
-            case SDLK_DOWN: keyState["down"] = true; break;
-            case SDLK_LEFT: keyState["left"] = true; break;
-            case SDLK_RIGHT: keyState["right"] = true; break;
+void checkMovement(const SDL_Event& event, InputState& input) {
+    if (event.type != SDL_KEYDOWN && event.type != SDL_KEYUP) return;
+    bool down = event.type == SDL_KEYDOWN;
+    switch (event.key.keysym.sym) {
+        case SDLK_UP: input.up = down; break;
+        case SDLK_DOWN: input.down = down; break;
+        case SDLK_LEFT: input.left = down; break;
+        case SDLK_RIGHT: input.right = down; break;
 
-            // WASD
-            case SDLK_w: keyState["up"] = true; break;
-            case SDLK_s: keyState["down"] = true; break;
-            case SDLK_a: keyState["left"] = true; break;
-            case SDLK_d: keyState["right"] = true; break;
-            
-            case SDLK_j: keyState["j"] = true; break;
-        }
-    } else if (event.type == SDL_KEYUP) {
-        switch (event.key.keysym.sym) {
-            case SDLK_UP: keyState["up"] = false; break;
-            case SDLK_DOWN: keyState["down"] = false; break;
-            case SDLK_LEFT: keyState["left"] = false; break;
-            case SDLK_RIGHT: keyState["right"] = false; break;
+        // WASD
+        case SDLK_w: input.up = down; break;
+        case SDLK_s: input.down = down; break;
+        case SDLK_a: input.left = down; break;
+        case SDLK_d: input.right = down; break;
 
-            // WASD
-            case SDLK_w: keyState["up"] = false; break;
-            case SDLK_s: keyState["down"] = false; break;
-            case SDLK_a: keyState["left"] = false; break;
-            case SDLK_d: keyState["right"] = false; break;
-            
-            case SDLK_j: keyState["j"] = false; break;
-        }
+        case SDLK_j: input.j = down; break;
     }
 }
 
-void checkMouseMovement(SDL_Event event, std::map<std::string, bool>& mouseState) {
+void checkMouseMovement(const SDL_Event& event, InputState& input) {
     if (event.type == SDL_MOUSEMOTION) {
-        mouseX = event.motion.x;
-        mouseY = event.motion.y;
-    } else if (event.type == SDL_MOUSEBUTTONDOWN) {
-        switch (event.button.button) {
-            case SDL_BUTTON_LEFT: mouseState["left"] = true; break;
-            case SDL_BUTTON_MIDDLE: mouseState["middle"] = true; break;
-            case SDL_BUTTON_RIGHT: mouseState["right"] = true; break;
-        }
-    }
-    else if (event.type == SDL_MOUSEBUTTONUP) {
+        input.mouseX = event.motion.x;
+        input.mouseY = event.motion.y;
+    } else if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP) {
+        bool down = event.type == SDL_MOUSEBUTTONDOWN;
         switch (event.button.button) {
-            case SDL_BUTTON_LEFT: mouseState["left"] = false; break;
-            case SDL_BUTTON_MIDDLE: mouseState["middle"] = false; break;
-            case SDL_BUTTON_RIGHT: mouseState["right"] = false; break;
+            case SDL_BUTTON_LEFT: input.mouseLeft = down; break;
+            case SDL_BUTTON_MIDDLE: input.mouseMiddle = down; break;
+            case SDL_BUTTON_RIGHT: input.mouseRight = down; break;
         }
     }
 }
 
-void renderText(SDL_Renderer* renderer, const std::string& text, int x, int y, int fontSize, SDL_Color color) {
-    static TTF_Font* font = nullptr;
-    static int cachedFontSize = 0;
-    static bool ttfInitialized = false;
-    
-    if (!ttfInitialized) {
-        if (TTF_Init() == -1) {
-            std::cerr << "SDL_ttf could not initialize! SDL_ttf Error: " << TTF_GetError() << std::endl;
-            return;
-        }
-        ttfInitialized = true;
+TTF_Font* FontCache::get(int size) {
+    auto it = fonts.find(size);
+    if (it != fonts.end()) return it->second;
+
+    // this is gonna die hard on non-windows machine
+    TTF_Font* font = TTF_OpenFont("C:/Windows/Fonts/Arial.ttf", size);
+    if (!font) {
+        std::cerr << "Failed to load font! SDL_ttf Error: " << TTF_GetError() << std::endl;
     }
-    
-    if (!font || cachedFontSize != fontSize) {
-        if (font) {
-            TTF_CloseFont(font);
-            font = nullptr;
-        }
-        
-        // this is gonna die hard on non-windows machine
-        font = TTF_OpenFont("C:/Windows/Fonts/Arial.ttf", fontSize);
-        
-        if (!font) {
-            std::cerr << "Failed to load font! SDL_ttf Error: " << TTF_GetError() << std::endl;
-            return;
-        }
-        
-        cachedFontSize = fontSize;
+    fonts[size] = font; // null too, so a missing font is only looked for once
+    return font;
+}
+
+void FontCache::close() {
+    for (auto& [size, font] : fonts) {
+        if (font) TTF_CloseFont(font);
     }
+    fonts.clear();
+}
+
+void renderText(Window* window, const std::string& text, int x, int y, int fontSize, SDL_Color color) {
+    renderText(window, text.c_str(), x, y, fontSize, color);
+}
+
+void renderText(Window* window, const char* text, int x, int y, int fontSize, SDL_Color color) {
+    // ttf is initialized by init(), no window means no renderer and no text either
+    SDL_Renderer* renderer = window->renderer;
+    TTF_Font* font = window->fonts.get(fontSize);
+    if (!renderer || !font) return;
     
-    SDL_Surface* textSurface = TTF_RenderText_Blended(font, text.c_str(), color);
+    SDL_Surface* textSurface = TTF_RenderText_Blended(font, text, color);
     if (!textSurface) {
         std::cerr << "Unable to render text surface! SDL_ttf Error: " << TTF_GetError() << std::endl;
         return;
@@ -256,11 +249,3 @@ void renderText(SDL_Renderer* renderer, const std::string& text, int x, int y, i
     
     SDL_DestroyTexture(textTexture);
 }
-
-map<string, bool> getKeyState() {
-    return keyState;
-}
-
-map<string, bool> getMouseState() {
-    return mouseState;
-}
\ No newline at end of file
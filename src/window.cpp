@@ -1,5 +1,8 @@
 #include "../include/window.h"
 #include "../include/utils.h"
+#include "../include/alloc_tracker.h"
+#include "../include/state_stream.h"
+#include "../include/tween.h"
 #include <iostream>
 
 using namespace std;
@@ -37,9 +40,25 @@ Window::Window(int x, int y, int width, int height, float shrinkSpeed, string ti
     pair<int, int> resolution = getResolution();
     screenWidth = resolution.first;
     screenHeight = resolution.second;
+    osRect = {x, y, width, height};
+}
+
+Window::Window(int x, int y, int width, int height, float shrinkSpeed) :
+                x(x), y(y),
+                width(width), height(height), shrinkSpeed(shrinkSpeed),
+                title("headless"),
+                window(nullptr),
+                renderer(nullptr),
+                headless(true) {
+    pair<int, int> resolution = getResolution();
+    screenWidth = resolution.first;
+    screenHeight = resolution.second;
+    osRect = {x, y, width, height};
 }
 
 Window::~Window() {
+    textures.cleanup(); // textures and fonts go before the renderer does
+    fonts.close();
     if (renderer) {
         SDL_DestroyRenderer(renderer);
         renderer = nullptr;
@@ -52,6 +71,7 @@ Window::~Window() {
 
 void Window::setTitle(const string& newTitle) {
     title = newTitle;
+    if (!window) return;
     SDL_SetWindowTitle(window, title.c_str());
 }
 
@@ -78,7 +98,7 @@ void Window::checkScreenEdgesCollision() {
     }
     
     // Update window position
-    SDL_SetWindowPosition(window, x, y);
+    setPos(x, y);
 }
 
 
@@ -86,13 +106,22 @@ void Window::checkScreenEdgesCollision() {
 void Window::setPos(int x, int y) {
     this->x = x;
     this->y = y;
-    SDL_SetWindowPosition(window, x, y);
 }
 
 void Window::setSize(int width, int height) {
     this->width = width;
     this->height = height;
-    SDL_SetWindowSize(window, width, height);
+}
+
+void Window::syncToOS(const SDL_Rect& bounds) {
+    if (!window) return;
+    if (bounds.x != osRect.x || bounds.y != osRect.y) {
+        SDL_SetWindowPosition(window, bounds.x, bounds.y);
+    }
+    if (bounds.w != osRect.w || bounds.h != osRect.h) {
+        SDL_SetWindowSize(window, bounds.w, bounds.h);
+    }
+    osRect = bounds;
 }
 
 // helper clamp (std::clamp doesn't work for some reason)
@@ -110,9 +139,7 @@ void Window::getDimensions(int& x, int& y, int& width, int& height) {
 
 // resize-by
 void Window::createResizeRequest(int top, int bottom, int left, int right, int initialSpeed, float duration) {
-    float now = SDL_GetTicks() / 1000.0f;
-
-    ResizeRequest request(top, bottom, left, right, duration, now, 0.0f, initialSpeed);
+    ResizeRequest request(top, bottom, left, right, duration, clock, 0.0f, initialSpeed);
 
     resizeRequests.push_back(request);
 }
@@ -144,7 +171,7 @@ void Window::applyResizeRequest(ResizeRequest& request, float deltaTime) {
            // there's some predefined easing functions declared below, plug whatever is needed in
            // maybe i'll work on it more in the future
 
-        request.elapsed = (SDL_GetTicks() / 1000.0f) - request.animationStartTime;
+        request.elapsed = clock - request.animationStartTime;
         float progress = std::min(request.elapsed / request.animationDuration, 1.0f);
 
         /*
@@ -174,8 +201,9 @@ void Window::applyResizeRequest(ResizeRequest& request, float deltaTime) {
 
         else { // apply easing for the current frame
             // calculate progress difference
-            float easingNow = easeOutQuad(progress);
-            float easingLast = easeOutQuad(request.lastProgress);
+            // the curves are in tween.h
+            float easingNow = ease(Easing::OutQuad, progress);
+            float easingLast = ease(Easing::OutQuad, request.lastProgress);
 
             // speed delta
             float speedFactor = 1.0f - progress;
@@ -210,6 +238,20 @@ void Window::applyResizeRequest(ResizeRequest& request, float deltaTime) {
 }
 
 void Window::update(float deltaTime) {
+    ALLOC_SCOPE("window");
+
+    // resizing works in whole pixels and truncates every step, so the feel was tuned
+    // for one step per 60fps frame. keep that cadence however fast the simulation runs
+    float windowStep = 1.0f / 60.0f;
+    stepAccumulator += deltaTime;
+    while (stepAccumulator >= windowStep - 1e-6f) { // epsilon, two 120hz steps should make one 60hz one
+        stepAccumulator -= windowStep;
+        step(windowStep);
+    }
+}
+
+void Window::step(float deltaTime) {
+    clock += deltaTime;
     naturalShrinking(deltaTime); // might as well
     auto it = resizeRequests.begin();
     while (it != resizeRequests.end()) {
@@ -231,42 +273,6 @@ SDL_Rect Window::getBounds() {
     return bounds;
 }
 
-float Window::easeOutQuad(float progress) {
-    // clamp
-    progress = std::min(1.0f, std::max(0.0f, progress));
-
-    // ease out quad function
-    // f(t) = 1 - (1 - t)^2
-    return 1.0f - std::pow(1.0f - progress, 2);
-}
-
-float Window::easeOutCubic(float progress) {
-    // clamp
-    progress = std::min(1.0f, std::max(0.0f, progress));
-
-    // ease out cubic function
-    // f(t) = 1 - (1 - t)^3
-    return 1.0f - std::pow(1.0f - progress, 3);
-}
-
-float Window::easeOutQuart(float progress) {
-    // clamp
-    progress = std::min(1.0f, std::max(0.0f, progress));
-
-    // ease out quart function
-    // f(t) = 1 - (1 - t)^4
-    return 1.0f - std::pow(1.0f - progress, 4);
-}
-
-float Window::easeOutExpo(float progress) {
-    // clamp
-    progress = std::min(1.0f, std::max(0.0f, progress));
-
-    // ease out expo function
-    // f(t) = 1 - 2^(-10 * t)
-    return 1.0f - std::pow(2.0f, -10.0f * progress);
-}
-
 void Window::naturalShrinking(const float &deltaTime) {
     int centerX = x + width / 2;
     int centerY = y + height / 2;
@@ -318,3 +324,35 @@ void Window::naturalShrinking(const float &deltaTime) {
         createResizeRequest(-topDelta, -bottomDelta, -leftDelta, -rightDelta, 0, 0.0f);
     }
 }
+
+void Window::saveState(StateWriter& out) const {
+    out.write(x);
+    out.write(y);
+    out.write(width);
+    out.write(height);
+    out.write(stepAccumulator);
+    out.write(clock);
+    out.write(screenEdges);
+    out.write(uint32_t(resizeRequests.size()));
+    for (const ResizeRequest& request : resizeRequests) {
+        out.write(request);
+    }
+}
+
+void Window::loadState(StateReader& in) {
+    in.read(x);
+    in.read(y);
+    in.read(width);
+    in.read(height);
+    in.read(stepAccumulator);
+    in.read(clock);
+    in.read(screenEdges);
+    uint32_t requestCount = 0;
+    in.read(requestCount);
+    resizeRequests.clear();
+    for (uint32_t i = 0; i < requestCount && in.ok(); i++) {
+        ResizeRequest request(0, 0, 0, 0, 0.0f, 0.0f, 0.0f);
+        in.read(request);
+        resizeRequests.push_back(request);
+    }
+}